@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/Archive.hpp> // class implemented
+
+#include <libmultidraw/Creator.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+using namespace multidraw;
+
+const size_t SIZE_BYTES = 4;
+
+Archive::Archive(std::ostream& out) :
+  _out(&out),
+  _in(nullptr),
+  _creator(nullptr),
+  _editor(nullptr),
+  _cursor(0),
+  _limit(0),
+  _depth(0),
+  _good(true),
+  _skipped(0)
+{
+}// constructor
+
+Archive::Archive(std::istream& in, Creator& creator, Editor* editor) :
+  _out(nullptr),
+  _in(&in),
+  _creator(&creator),
+  _editor(editor),
+  _cursor(0),
+  _limit(0),
+  _depth(0),
+  _good(true),
+  _skipped(0)
+{
+}// constructor
+
+bool
+Archive::write(const Command& cmd)
+{
+  size_t start = begin(cmd.classid());
+  _good = cmd.write(*this) && _good;
+  end(start);
+  return _good;
+}// write
+
+bool
+Archive::write(const Component& comp)
+{
+  size_t start = begin(comp.classid());
+  _good = comp.write(*this) && _good;
+  end(start);
+  return _good;
+}// write
+
+Command*
+Archive::read_command()
+{
+  while (_good) {
+    size_t outer = _limit;
+    ClassId id;
+    size_t last;
+    if (!open(id, last)) {
+      return nullptr;
+    }
+
+    Command* cmd = _creator->create(id, _editor);
+    if (cmd != nullptr) {
+      _depth++;
+      _limit = last;
+      _good = cmd->read(*this) && _good;
+      _depth--;
+    } else {
+      _skipped++;
+    }
+    _cursor = last;
+    _limit = outer;
+
+    if (!_good) {
+      delete cmd;
+      return nullptr;
+    }
+    if (cmd != nullptr || _depth > 0) {
+      return cmd;
+    }
+  }
+  return nullptr;
+}// read_command
+
+Component*
+Archive::read_component()
+{
+  while (_good) {
+    size_t outer = _limit;
+    ClassId id;
+    size_t last;
+    if (!open(id, last)) {
+      return nullptr;
+    }
+
+    Component* comp = _creator->create(id);
+    if (comp != nullptr) {
+      _depth++;
+      _limit = last;
+      _good = comp->read(*this) && _good;
+      _depth--;
+    } else {
+      _skipped++;
+    }
+    _cursor = last;
+    _limit = outer;
+
+    if (!_good) {
+      delete comp;
+      return nullptr;
+    }
+    if (comp != nullptr || _depth > 0) {
+      return comp;
+    }
+  }
+  return nullptr;
+}// read_component
+
+void
+Archive::write_varint(uint64_t value)
+{
+  while (value >= 0x80) {
+    _buffer.push_back((char)(value | 0x80));
+    value >>= 7;
+  }
+  _buffer.push_back((char)value);
+}// write_varint
+
+void
+Archive::write_float(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  char bytes[4] = { (char)bits, (char)(bits >> 8), (char)(bits >> 16), (char)(bits >> 24) };
+  _buffer.append(bytes, sizeof(bytes));
+}// write_float
+
+void
+Archive::write_bytes(const void* data, size_t size)
+{
+  _buffer.append(static_cast<const char*>(data), size);
+}// write_bytes
+
+void
+Archive::write_string(const std::string& value)
+{
+  write_varint(value.size());
+  write_bytes(value.data(), value.size());
+}// write_string
+
+void
+Archive::write_path(const Component* comp)
+{
+  if (comp == nullptr) {
+    write_varint(0);
+    return;
+  }
+
+  size_t depth = 0;
+  for (const Component* node = comp; node->parent() != nullptr; node = node->parent()) {
+    depth++;
+  }
+  write_varint(depth + 1);
+
+  // Indices from the root down: find each step's ancestor at that depth.
+  for (size_t level = depth; level > 0; level--) {
+    const Component* node = comp;
+    for (size_t up = 1; up < level; up++) {
+      node = node->parent();
+    }
+    Component* parent = node->parent();
+    size_t index = 0;
+    while (parent->child(index) != node) {
+      index++;
+    }
+    write_varint(index);
+  }
+}// write_path
+
+uint64_t
+Archive::read_varint()
+{
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (_cursor >= _limit) {
+      _good = false;
+      return 0;
+    }
+    auto byte = (uint8_t)_buffer[_cursor++];
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  _good = false;
+  return 0;
+}// read_varint
+
+float
+Archive::read_float()
+{
+  uint8_t bytes[4];
+  if (!read_bytes(bytes, sizeof(bytes))) {
+    return 0.0F;
+  }
+  uint32_t bits = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}// read_float
+
+bool
+Archive::read_bytes(void* data, size_t size)
+{
+  if (size > remaining()) {
+    _good = false;
+    return false;
+  }
+  std::memcpy(data, _buffer.data() + _cursor, size);
+  _cursor += size;
+  return true;
+}// read_bytes
+
+std::string
+Archive::read_string()
+{
+  size_t size = read_varint();
+  if (size > remaining()) {
+    _good = false;
+    return std::string();
+  }
+  std::string value(_buffer.data() + _cursor, size);
+  _cursor += size;
+  return value;
+}// read_string
+
+Component*
+Archive::read_path()
+{
+  size_t length = read_varint();
+  if (length == 0) {
+    return nullptr;
+  }
+
+  Component* comp = nullptr;
+  if (_editor != nullptr && _editor->component() != nullptr) {
+    comp = _editor->component()->root();
+  }
+
+  // Every step is read even once one misses, so what follows is read
+  // from the right place.
+  bool found = comp != nullptr;
+  for (size_t step = 1; step < length && _good; step++) {
+    uint64_t index = read_varint();
+    if (found) {
+      comp = comp->child(index);
+      found = comp != nullptr;
+    }
+  }
+  return found && _good ? comp : nullptr;
+}// read_path
+
+size_t
+Archive::begin(ClassId id)
+{
+  _depth++;
+  write_varint(id);
+  size_t start = _buffer.size();
+  _buffer.append(SIZE_BYTES, '\0');
+  return start;
+}// begin
+
+void
+Archive::end(size_t start)
+{
+  auto size = (uint32_t)(_buffer.size() - start - SIZE_BYTES);
+  for (size_t byte = 0; byte < SIZE_BYTES; byte++) {
+    _buffer[start + byte] = (char)(size >> (8 * byte));
+  }
+
+  if (--_depth == 0) {
+    _out->write(_buffer.data(), (std::streamsize)_buffer.size());
+    _good = _good && _out->good();
+    _buffer.clear();
+  }
+}// end
+
+bool
+Archive::open(ClassId& id, size_t& last)
+{
+  if (_depth == 0) {
+    // Load the whole outermost record, then parse it from memory.
+    int first = _in->get();
+    if (first == std::char_traits<char>::eof()) {
+      return false;
+    }
+
+    _buffer.clear();
+    _buffer.push_back((char)first);
+    while ((first & 0x80) != 0 && _buffer.size() < 10) {
+      first = _in->get();
+      if (first == std::char_traits<char>::eof()) {
+        _good = false;
+        return false;
+      }
+      _buffer.push_back((char)first);
+    }
+
+    size_t header = _buffer.size();
+    _buffer.resize(header + SIZE_BYTES);
+    if (!_in->read(&_buffer[header], SIZE_BYTES)) {
+      _good = false;
+      return false;
+    }
+
+    size_t size = 0;
+    for (size_t byte = 0; byte < SIZE_BYTES; byte++) {
+      size |= (size_t)(uint8_t)_buffer[header + byte] << (8 * byte);
+    }
+    _buffer.resize(header + SIZE_BYTES + size);
+    if (!_in->read(&_buffer[header + SIZE_BYTES], (std::streamsize)size)) {
+      _good = false;
+      return false;
+    }
+
+    _cursor = 0;
+    _limit = _buffer.size();
+  }
+
+  id = (ClassId)read_varint();
+  uint8_t bytes[SIZE_BYTES];
+  if (!read_bytes(bytes, SIZE_BYTES)) {
+    return false;
+  }
+  size_t size = 0;
+  for (size_t byte = 0; byte < SIZE_BYTES; byte++) {
+    size |= (size_t)bytes[byte] << (8 * byte);
+  }
+  if (size > remaining()) {
+    _good = false;
+    return false;
+  }
+
+  last = _cursor + size;
+  return _good;
+}// open
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_ARCHIVE_HPP
+#define LIBMULTIDRAW_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include <libmultidraw/ClassId.hpp>
+
+namespace multidraw {
+
+  class Command;
+  class Component;
+  class Creator;
+  class Editor;
+
+  /**
+   * @brief Compact binary storage for Commands and Components.
+   *
+   * Each object is a record: its ClassId as a varint, the size of its body
+   * as four bytes, then the body written by its write() method. Records
+   * nest. A reader skips records whose ClassId its Creator does not
+   * define, and any trailing part of a body that read() leaves unread,
+   * so older readers can open newer files. Numbers are little-endian.
+   */
+  class Archive {
+  public:
+    /// An Archive that writes to a stream.
+    explicit Archive(std::ostream&);
+    /**
+     * An Archive that reads from a stream. Commands are created for the
+     * Editor, and the Components they refer to are found under its root.
+     */
+    Archive(std::istream&, Creator&, Editor* = nullptr);
+
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+
+    /// False once a write fails or a read finds malformed data.
+    bool good() const { return _good; };
+    /// Records skipped because their class is unknown.
+    size_t skipped() const { return _skipped; };
+
+    Editor* editor() const { return _editor; };
+    Creator* creator() const { return _creator; };
+
+    bool write(const Command&);
+    bool write(const Component&);
+    /// The next Command, or nullptr at the end, on error or for an unknown nested record.
+    Command* read_command();
+    /// The next Component, or nullptr at the end, on error or for an unknown nested record.
+    Component* read_component();
+
+    void write_varint(uint64_t);
+    void write_float(float);
+    void write_bytes(const void*, size_t);
+    void write_string(const std::string&);
+    /// A Component by the child indices leading to it from its root.
+    void write_path(const Component*);
+
+    uint64_t read_varint();
+    float read_float();
+    bool read_bytes(void*, size_t);
+    std::string read_string();
+    Component* read_path();
+
+    /// Bytes left in the body being read.
+    size_t remaining() const { return _limit - _cursor; };
+
+  private:
+    size_t begin(ClassId);
+    void end(size_t);
+    bool open(ClassId&, size_t&);
+
+    std::ostream* _out;
+    std::istream* _in;
+    Creator* _creator;
+    Editor* _editor;
+    /// The outermost record being written, or being read.
+    std::string _buffer;
+    size_t _cursor;
+    size_t _limit;
+    int _depth;
+    bool _good;
+    size_t _skipped;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_ARCHIVE_HPP
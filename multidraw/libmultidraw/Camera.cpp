@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/Camera.hpp> // class implemented
+
+#include <cmath>
+
+using namespace multidraw;
+
+const float ZOOM = 4.0F;
+const float PANX = 0.0F;
+const float PANY = 0.0F;
+const float RADIANS = 3.14159265F / 180.0F;
+
+Camera::Camera() :
+  _zoom(ZOOM),
+  _pan_x(PANX),
+  _pan_y(PANY),
+  _pitch(0.0F),
+  _yaw(0.0F),
+  _axes{1.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 1.0F}
+{
+}// constructor
+
+void
+Camera::reset()
+{
+  _zoom = ZOOM;
+  _pan_x = PANX;
+  _pan_y = PANY;
+}// reset
+
+void
+Camera::pan(float deltax, float deltay)
+{
+  _pan_x += deltax / _zoom;
+  _pan_y += deltay / _zoom;
+}// pan
+
+void
+Camera::zoom(float factor)
+{
+  _zoom *= factor;
+}// zoom
+
+void
+Camera::orient(float pitch, float yaw)
+{
+  _pitch = pitch;
+  _yaw = yaw;
+
+  // The same as glRotatef(pitch, 1, 0, 0) followed by glRotatef(yaw, 0, 1, 0).
+  float cp = std::cos(pitch * RADIANS);
+  float sp = std::sin(pitch * RADIANS);
+  float cy = std::cos(yaw * RADIANS);
+  float sy = std::sin(yaw * RADIANS);
+
+  _axes[0] = cy;       _axes[1] = 0.0F; _axes[2] = sy;
+  _axes[3] = sp * sy;  _axes[4] = cp;   _axes[5] = -sp * cy;
+  _axes[6] = -cp * sy; _axes[7] = sp;   _axes[8] = cp * cy;
+}// orient
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_CAMERA_HPP
+#define LIBMULTIDRAW_CAMERA_HPP
+
+namespace multidraw {
+
+  /**
+   * @brief The view onto a Component hierarchy.
+   *
+   * World coordinates are turned to the orientation, offset by the pan
+   * and scaled by zoom(), then projected orthographically onto a window
+   * centered on the origin, keeping depths within [-CLIPZ, CLIPZ]. Each
+   * Viewer has its own, so views of one case can look from the occlusal,
+   * buccal and lingual sides at once.
+   */
+  class Camera {
+  public:
+    static const int CLIPZ = 100;
+
+    Camera();
+
+    float zoom() const { return _zoom; };
+    float pan_x() const { return _pan_x; };
+    float pan_y() const { return _pan_y; };
+    /// Degrees about the window's x axis, applied after the yaw.
+    float pitch() const { return _pitch; };
+    /// Degrees about the world's y axis.
+    float yaw() const { return _yaw; };
+
+    /// Back to the initial zoom and pan. The orientation is kept.
+    void reset();
+    /// Move by a distance in window pixels.
+    void pan(float deltax, float deltay);
+    void zoom(float factor);
+    void orient(float pitch, float yaw);
+
+    /**
+     * World to window coordinates for a width x height window: origin at
+     * the top-left, y down, and depth increasing away from the viewer.
+     */
+    void project(const float* xyz, int width, int height, float* out) const
+    {
+      float x = _axes[0] * xyz[0] + _axes[1] * xyz[1] + _axes[2] * xyz[2];
+      float y = _axes[3] * xyz[0] + _axes[4] * xyz[1] + _axes[5] * xyz[2];
+      float z = _axes[6] * xyz[0] + _axes[7] * xyz[1] + _axes[8] * xyz[2];
+      out[0] = _zoom * (x + _pan_x) + (float)(width / 2);
+      out[1] = (float)(height / 2) - _zoom * (y + _pan_y);
+      out[2] = -z;
+    };
+
+  private:
+    float _zoom;
+    float _pan_x;
+    float _pan_y;
+    float _pitch;
+    float _yaw;
+    /// The rotation for pitch and yaw, row-major.
+    float _axes[9];
+  };
+
+}
+
+#endif // LIBMULTIDRAW_CAMERA_HPP
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_CLASS_ID_HPP
+#define LIBMULTIDRAW_CLASS_ID_HPP
+
+#include <cstdint>
+
+namespace multidraw {
+
+  /**
+   * @brief Identifies a Command or Component class in an Archive.
+   *
+   * Ids are small integers so that Creator can look them up by index.
+   * They are written to files; never renumber one.
+   */
+  using ClassId = uint32_t;
+
+  const ClassId UNDEFINED_CLASS = 0;
+
+  // Components
+
+  const ClassId COMPONENT = 1;
+  const ClassId MESH_COMPONENT = 2;
+
+  // Commands
+
+  const ClassId COMMAND = 100;
+  const ClassId MACRO_CMD = 101;
+  const ClassId SAVE_CMD = 102;
+  const ClassId SAVE_AS_CMD = 103;
+  const ClassId INPUT_CMD = 104;
+  const ClassId UNDO_CMD = 105;
+  const ClassId REDO_CMD = 106;
+
+  /// Applications number their own classes from here up.
+  const ClassId USER_CLASS = 1000;
+
+}
+
+#endif // LIBMULTIDRAW_CLASS_ID_HPP
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_CONSTRAINT_HPP
+#define LIBMULTIDRAW_CONSTRAINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace multidraw {
+
+  class Component;
+
+  /**
+   * @brief A relation that keeps some Components up to date with others.
+   *
+   * An attachment that follows a tooth reads the tooth and writes the
+   * attachment; a dimension reads what it measures and writes its label.
+   * A ConstraintNetwork calls solve() whenever an input has been touched.
+   * solve() changes its outputs through their setters, which touch them,
+   * so whatever depends on them in turn is solved after it.
+   */
+  class Constraint {
+  public:
+    Constraint(const std::vector<Component*>& inputs, const std::vector<Component*>& outputs);
+    virtual ~Constraint() {};
+
+    Constraint(const Constraint&) = delete;
+    Constraint& operator=(const Constraint&) = delete;
+
+    const std::vector<Component*>& inputs() const { return _inputs; };
+    const std::vector<Component*>& outputs() const { return _outputs; };
+
+    /// Bring the outputs up to date with the inputs.
+    virtual void solve() = 0;
+
+    /// Greater than the rank of every Constraint writing one of its inputs.
+    size_t rank() const { return _rank; };
+
+  private:
+    friend class ConstraintNetwork;
+
+    std::vector<Component*> _inputs;
+    std::vector<Component*> _outputs;
+    size_t _rank;
+    /// Waiting to be solved.
+    bool _queued;
+    /// The ConstraintNetwork pass that last solved it.
+    uint64_t _pass;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_CONSTRAINT_HPP
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/ConstraintNetwork.hpp> // class implemented
+
+#include <libmultidraw/Constraint.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+#include <algorithm>
+#include <unordered_set>
+
+using namespace multidraw;
+
+static bool
+later(const Constraint* a, const Constraint* b)
+{
+  return a->rank() > b->rank();
+}// later
+
+ConstraintNetwork::ConstraintNetwork() :
+  _pass(0),
+  _solving(false),
+  _stats(),
+  _owner(std::this_thread::get_id())
+{
+}// constructor
+
+ConstraintNetwork::~ConstraintNetwork()
+{
+  for (auto& [comp, node] : _nodes) {
+    comp->network(nullptr);
+  }
+}// destructor
+
+Constraint*
+ConstraintNetwork::add(std::unique_ptr<Constraint> constraint)
+{
+  if (closes(constraint.get())) {
+    _stats.cycles++;
+    return nullptr;
+  }
+
+  Constraint* added = constraint.get();
+  _constraints.push_back(std::move(constraint));
+  for (auto* comp : added->_inputs) {
+    link(comp, added, true);
+  }
+  for (auto* comp : added->_outputs) {
+    link(comp, added, false);
+  }
+
+  rank(added);
+  queue(added);
+  return added;
+}// add
+
+void
+ConstraintNetwork::remove(Constraint* constraint)
+{
+  auto iter = std::find_if(_constraints.begin(), _constraints.end(),
+                           [constraint](const auto& owned) { return owned.get() == constraint; });
+  if (iter == _constraints.end()) {
+    return;
+  }
+
+  if (constraint->_queued) {
+    auto dirty = std::find(_dirty.begin(), _dirty.end(), constraint);
+    if (dirty != _dirty.end()) {
+      _dirty.erase(dirty);
+      std::make_heap(_dirty.begin(), _dirty.end(), later);
+    }
+  }
+
+  for (auto* comp : constraint->_inputs) {
+    unlink(comp, constraint, true);
+  }
+  for (auto* comp : constraint->_outputs) {
+    unlink(comp, constraint, false);
+  }
+
+  // Ranks only need to be upper bounds, so nothing downstream changes.
+  std::swap(*iter, _constraints.back());
+  _constraints.pop_back();
+}// remove
+
+void
+ConstraintNetwork::remove(Component* comp)
+{
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _changes.erase(std::remove(_changes.begin(), _changes.end(), comp), _changes.end());
+  }
+
+  auto iter = _nodes.find(comp);
+  if (iter == _nodes.end()) {
+    return;
+  }
+
+  std::vector<Constraint*> attached(iter->second.readers);
+  attached.insert(attached.end(), iter->second.writers.cbegin(), iter->second.writers.cend());
+  std::sort(attached.begin(), attached.end());
+  attached.erase(std::unique(attached.begin(), attached.end()), attached.end());
+  for (auto* constraint : attached) {
+    remove(constraint);
+  }
+}// remove
+
+void
+ConstraintNetwork::changed(Component* comp)
+{
+  // Other threads may not even look at the graph; the owner merges later.
+  if (std::this_thread::get_id() != _owner) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _changes.push_back(comp);
+    return;
+  }
+
+  auto iter = _nodes.find(comp);
+  if (iter == _nodes.end()) {
+    return;
+  }
+
+  for (auto* reader : iter->second.readers) {
+    queue(reader);
+  }
+}// changed
+
+bool
+ConstraintNetwork::dirty() const
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return !_dirty.empty() || !_changes.empty();
+}// dirty
+
+size_t
+ConstraintNetwork::solve(const std::function<void(const Constraint&)>& solved)
+{
+  if (_solving) {
+    return 0;
+  }
+  merge();
+  if (_dirty.empty()) {
+    return 0;
+  }
+
+  _solving = true;
+  _pass++;
+  _stats.passes++;
+  _stats.last = 0;
+
+  // Solved already this pass: something wrote its inputs without saying so.
+  std::vector<Constraint*> deferred;
+
+  while (!_dirty.empty()) {
+    std::pop_heap(_dirty.begin(), _dirty.end(), later);
+    Constraint* constraint = _dirty.back();
+    _dirty.pop_back();
+
+    if (constraint->_pass == _pass) {
+      deferred.push_back(constraint);
+      _stats.deferred++;
+      continue;
+    }
+
+    constraint->_queued = false;
+    constraint->_pass = _pass;
+    constraint->solve();
+    _stats.last++;
+    if (solved) {
+      solved(*constraint);
+    }
+  }
+
+  for (auto* constraint : deferred) {
+    _dirty.push_back(constraint);
+    std::push_heap(_dirty.begin(), _dirty.end(), later);
+  }
+
+  _stats.solved += _stats.last;
+  _solving = false;
+  return _stats.last;
+}// solve
+
+bool
+ConstraintNetwork::closes(const Constraint* constraint) const
+{
+  // Whether anything downstream of its outputs feeds its inputs.
+  std::vector<Component*> stack(constraint->_outputs);
+  std::unordered_set<const Constraint*> visited;
+
+  while (!stack.empty()) {
+    Component* comp = stack.back();
+    stack.pop_back();
+
+    if (std::find(constraint->_inputs.cbegin(), constraint->_inputs.cend(), comp) != constraint->_inputs.cend()) {
+      return true;
+    }
+
+    auto iter = _nodes.find(comp);
+    if (iter == _nodes.end()) {
+      continue;
+    }
+    for (const auto* reader : iter->second.readers) {
+      if (visited.insert(reader).second) {
+        stack.insert(stack.end(), reader->_outputs.cbegin(), reader->_outputs.cend());
+      }
+    }
+  }
+  return false;
+}// closes
+
+void
+ConstraintNetwork::rank(Constraint* constraint)
+{
+  constraint->_rank = 0;
+  for (auto* comp : constraint->_inputs) {
+    for (const auto* writer : _nodes[comp].writers) {
+      constraint->_rank = std::max(constraint->_rank, writer->_rank + 1);
+    }
+  }
+
+  // Push down whatever now depends on it; the graph is acyclic, so this ends.
+  std::vector<Constraint*> stack{constraint};
+  bool moved = false;
+  while (!stack.empty()) {
+    Constraint* upstream = stack.back();
+    stack.pop_back();
+
+    for (auto* comp : upstream->_outputs) {
+      for (auto* reader : _nodes[comp].readers) {
+        if (reader->_rank <= upstream->_rank) {
+          reader->_rank = upstream->_rank + 1;
+          moved = moved || reader->_queued;
+          stack.push_back(reader);
+        }
+      }
+    }
+  }
+
+  if (moved) {
+    std::make_heap(_dirty.begin(), _dirty.end(), later);
+  }
+}// rank
+
+void
+ConstraintNetwork::link(Component* comp, Constraint* constraint, bool reader)
+{
+  Node& node = _nodes[comp];
+  (reader ? node.readers : node.writers).push_back(constraint);
+  comp->network(this);
+}// link
+
+void
+ConstraintNetwork::unlink(Component* comp, Constraint* constraint, bool reader)
+{
+  auto iter = _nodes.find(comp);
+  if (iter == _nodes.end()) {
+    return;
+  }
+
+  auto& constraints = reader ? iter->second.readers : iter->second.writers;
+  auto found = std::find(constraints.begin(), constraints.end(), constraint);
+  if (found != constraints.end()) {
+    constraints.erase(found);
+  }
+
+  if (iter->second.readers.empty() && iter->second.writers.empty()) {
+    comp->network(nullptr);
+    _nodes.erase(iter);
+  }
+}// unlink
+
+void
+ConstraintNetwork::merge()
+{
+  std::vector<Component*> changes;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    changes.swap(_changes);
+  }
+  for (auto* comp : changes) {
+    changed(comp);
+  }
+}// merge
+
+void
+ConstraintNetwork::queue(Constraint* constraint)
+{
+  if (!constraint->_queued) {
+    constraint->_queued = true;
+    _dirty.push_back(constraint);
+    std::push_heap(_dirty.begin(), _dirty.end(), later);
+  }
+}// queue
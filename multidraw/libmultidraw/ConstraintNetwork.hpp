@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_CONSTRAINT_NETWORK_HPP
+#define LIBMULTIDRAW_CONSTRAINT_NETWORK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace multidraw {
+
+  class Component;
+  class Constraint;
+
+  /**
+   * @brief The Constraints between Components, solved incrementally.
+   *
+   * Touching a Component that a Constraint reads marks that Constraint
+   * dirty. solve() runs only the dirty Constraints, lowest rank first,
+   * and those they dirty in turn by changing their outputs. Nothing
+   * downstream of an unchanged value is visited, so a pass costs about
+   * as much as the change it follows, however many Constraints there
+   * are. Cycles are refused when a Constraint is added.
+   *
+   * A Constraint sees changes to the Components it reads, not to their
+   * children.
+   *
+   * The network belongs to the thread that made it. Changes reported
+   * from other threads, by the children of a parallel MacroCmd, are only
+   * recorded, and take effect when solve() next runs.
+   */
+  class ConstraintNetwork {
+  public:
+    struct Stats {
+      /// Constraints refused because they would close a cycle.
+      size_t cycles;
+      /// Calls to solve() that had work to do.
+      size_t passes;
+      /// Constraints solved since construction.
+      size_t solved;
+      /// Constraints solved on the most recent pass.
+      size_t last;
+      /// Constraints dirtied again within a pass and left for the next.
+      size_t deferred;
+    };
+
+    ConstraintNetwork();
+    ~ConstraintNetwork();
+
+    ConstraintNetwork(const ConstraintNetwork&) = delete;
+    ConstraintNetwork& operator=(const ConstraintNetwork&) = delete;
+
+    /**
+     * Adopt a Constraint, dirty so its outputs are set on the next pass.
+     * Returns nullptr, destroying it, when it would close a cycle.
+     */
+    Constraint* add(std::unique_ptr<Constraint>);
+    /// Destroy a Constraint.
+    void remove(Constraint*);
+    /// Destroy every Constraint that reads or writes a Component.
+    void remove(Component*);
+
+    /// Mark dirty every Constraint that reads a Component. Safe from any thread.
+    void changed(Component*);
+    /**
+     * Solve the dirty Constraints, calling solved after each one. Returns
+     * how many were solved.
+     */
+    size_t solve(const std::function<void(const Constraint&)>& solved = nullptr);
+
+    size_t size() const { return _constraints.size(); };
+    bool dirty() const;
+
+    const Stats& stats() const { return _stats; };
+
+  private:
+    struct Node {
+      std::vector<Constraint*> readers;
+      std::vector<Constraint*> writers;
+    };
+
+    bool closes(const Constraint*) const;
+    void rank(Constraint*);
+    void link(Component*, Constraint*, bool reader);
+    void unlink(Component*, Constraint*, bool reader);
+    void queue(Constraint*);
+    void merge();
+
+    std::unordered_map<Component*, Node> _nodes;
+    std::vector<std::unique_ptr<Constraint>> _constraints;
+    /// A heap on rank, lowest on top.
+    std::vector<Constraint*> _dirty;
+    uint64_t _pass;
+    bool _solving;
+    Stats _stats;
+    std::thread::id _owner;
+    /// Components changed on other threads, since the last merge.
+    std::vector<Component*> _changes;
+    mutable std::mutex _lock;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_CONSTRAINT_NETWORK_HPP
@@ -22,14 +22,68 @@
 
 #include <libmultidraw/Creator.hpp> // class implemented
 
+#include <libmultidraw/commands/InputCmd.hpp>
+#include <libmultidraw/commands/MacroCmd.hpp>
+#include <libmultidraw/commands/RedoCmd.hpp>
+#include <libmultidraw/commands/SaveAsCmd.hpp>
+#include <libmultidraw/commands/SaveCmd.hpp>
+#include <libmultidraw/commands/UndoCmd.hpp>
 #include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
 
 using namespace multidraw;
 
-Creator::Creator() { }
+Creator::Creator()
+{
+  define(COMPONENT, []() -> Component* { return new Component(); });
+  define(MESH_COMPONENT, []() -> Component* { return new MeshComponent(); });
+
+  define(MACRO_CMD, [](Editor* ed) -> Command* { return new MacroCmd(ed); });
+  define(SAVE_CMD, [](Editor* ed) -> Command* { return new SaveCmd(ed); });
+  define(SAVE_AS_CMD, [](Editor* ed) -> Command* { return new SaveAsCmd(ed, ""); });
+  define(INPUT_CMD, [](Editor* ed) -> Command* { return new InputCmd(ed); });
+  define(UNDO_CMD, [](Editor* ed) -> Command* { return new UndoCmd(ed); });
+  define(REDO_CMD, [](Editor* ed) -> Command* { return new RedoCmd(ed); });
+}// constructor
 
 Component*
 Creator::create()
 {
   return nullptr;
 }// create
+
+Component*
+Creator::create(ClassId id) const
+{
+  if (id < _components.size() && _components[id] != nullptr) {
+    return _components[id]();
+  }
+  return nullptr;
+}// create
+
+Command*
+Creator::create(ClassId id, Editor* ed) const
+{
+  if (id < _commands.size() && _commands[id] != nullptr) {
+    return _commands[id](ed);
+  }
+  return nullptr;
+}// create
+
+void
+Creator::define(ClassId id, ComponentMaker maker)
+{
+  if (id >= _components.size()) {
+    _components.resize(id + 1, nullptr);
+  }
+  _components[id] = maker;
+}// define
+
+void
+Creator::define(ClassId id, CommandMaker maker)
+{
+  if (id >= _commands.size()) {
+    _commands.resize(id + 1, nullptr);
+  }
+  _commands[id] = maker;
+}// define
@@ -23,19 +23,43 @@
 #ifndef LIBMULTIDRAW_CREATOR_HPP
 #define LIBMULTIDRAW_CREATOR_HPP
 
+#include <vector>
+
+#include <libmultidraw/ClassId.hpp>
+
 namespace multidraw {
+  class Command;
   class Component;
+  class Editor;
   
   /**
    * Creator is a participant in the BUILDER design pattern.
+   *
+   * It also maps each ClassId to a function making an empty instance of
+   * that class, for an Archive to fill in. The library's own classes are
+   * defined on construction; applications define theirs from USER_CLASS.
    */
   class Creator {
   public:
+    using ComponentMaker = Component* (*)();
+    using CommandMaker = Command* (*)(Editor*);
+
     Creator();
+    virtual ~Creator() = default;
 
     virtual Component* create();
-    
+
+    /// An empty Component of the class, or nullptr if it is not defined.
+    Component* create(ClassId) const;
+    /// An empty Command of the class for the Editor, or nullptr if it is not defined.
+    Command* create(ClassId, Editor*) const;
+
+    void define(ClassId, ComponentMaker);
+    void define(ClassId, CommandMaker);
+
   private:
+    std::vector<ComponentMaker> _components;
+    std::vector<CommandMaker> _commands;
   };
 
 }
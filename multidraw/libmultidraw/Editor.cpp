@@ -27,8 +27,10 @@
 #include <libmultidraw/Viewer.hpp>
 #include <libmultidraw/components/Component.hpp>
 #include <libmultidraw/commands/MacroCmd.hpp>
+#include <libmultidraw/renderers/BufferCache.hpp>
 #include <libmultidraw/state_vars/ComponentNameVar.hpp>
 #include <libmultidraw/state_vars/ModifiedStatusVar.hpp>
+#include <libmultidraw/state_vars/StateKey.hpp>
 #include <libmultidraw/state_vars/StateVar.hpp>
 #include <libmultidraw/tools/Tool.hpp>
 
@@ -49,8 +51,7 @@ Editor::Editor(const std::string& inpath, const std::string& outpath) :
   _command(nullptr),
   _name(nullptr),
   _modified(nullptr),
-  _window(nullptr),
-  _viewer(nullptr)
+  _window(nullptr)
 {
   Catalog* catalog = Multidraw::instance()->catalog();
 
@@ -68,6 +69,11 @@ Editor::Editor(const std::string& inpath, const std::string& outpath) :
 
   _outpath = new NameVar(outpath);
 
+  _states.resize(StateKey::OUTPATH.id() + 1, nullptr);
+  _states[StateKey::COMPONENTNAME.id()] = _name;
+  _states[StateKey::MODIFIED.id()] = _modified;
+  _states[StateKey::OUTPATH.id()] = _outpath;
+
   // try to parse commands from the input file, then execute
 
   _command = dynamic_cast<Command*> (new MacroCmd(this));
@@ -87,7 +93,9 @@ Editor::~Editor()
 void
 Editor::open()
 {
-  _window->show();
+  if (_window != nullptr && !Multidraw::instance()->headless()) {
+    _window->show();
+  }
 }// open
 
 void
@@ -98,35 +106,85 @@ Editor::close()
 void
 Editor::update() const
 {
-  Viewer* view;
-  for (int i = 0; (view = viewer(i)) != nullptr; ++i) {
-    view->update();
+  for (size_t i = 0; i < viewers(); ++i) {
+    Viewer* view = viewer((int)i);
+    if (view != nullptr) {
+      view->update();
+    }
   }
 }// update
 
+Viewer*
+Editor::viewer(int id) const
+{
+  return (id >= 0 && (size_t)id < _viewers.size()) ? _viewers[id] : nullptr;
+}// viewer
+
+void
+Editor::viewer(Viewer* viewer, int id)
+{
+  if (id < 0) {
+    return;
+  }
+  if ((size_t)id >= _viewers.size()) {
+    _viewers.resize(id + 1, nullptr);
+  }
+  _viewers[id] = viewer;
+
+  while (!_viewers.empty() && _viewers.back() == nullptr) {
+    _viewers.pop_back();
+  }
+}// viewer
+
+std::shared_ptr<BufferCache>
+Editor::buffers()
+{
+  std::shared_ptr<BufferCache> cache = _buffers.lock();
+  if (cache == nullptr) {
+    cache = std::make_shared<BufferCache>();
+    _buffers = cache;
+  }
+  return cache;
+}// buffers
+
 bool
 Editor::modified() const
 {
   return _modified->modified();
 }
 
-StateVar*
-Editor::state(const std::string& name) const
+void
+Editor::modified(bool modified)
 {
-  std::string ALLCAPS = name;
-  for (auto& character: ALLCAPS) { character = (char)std::toupper(character); }
+  if (_modified != nullptr) {
+    _modified->modified(modified);
+  }
+}// modified
 
-  StateVar* var = nullptr;
+std::string
+Editor::outpath() const
+{
+  return _outpath->name();
+}// outpath
 
-  if (ALLCAPS == "COMPONENTNAME") {
-    var = _name;
-  } else if (ALLCAPS == "MODIFIED") {
-    var = _modified;
-  } else if (ALLCAPS == "OUTPATH") {
-    var = _outpath;
-  }
+void
+Editor::outpath(const std::string& path)
+{
+  _outpath->name(path);
+}// outpath
 
-  return var;
+StateVar*
+Editor::state(const StateKey& key) const
+{
+  return key.id() < _states.size() ? _states[key.id()] : nullptr;
+}// state
+
+StateVar*
+Editor::state(const std::string& name) const
+{
+  // A name never registered has no variable, and looking it up must not add it.
+  std::optional<StateKey> key = StateKey::find(name);
+  return key ? state(*key) : nullptr;
 }// state
 
 int
@@ -141,4 +199,6 @@ Editor::init(Component* comp)
   _component = comp;
 
   _modified = new ModifiedStatusVar(_component);
+  _name = new ComponentNameVar(_component);
+  _name->update();
 }// init
@@ -23,18 +23,21 @@
 #ifndef LIBMULTIDRAW_EDITOR_HPP
 #define LIBMULTIDRAW_EDITOR_HPP
 
+#include <memory>
 #include <string>
 #include <vector>
 
 class Fl_Window;
 
 namespace multidraw {
+  class BufferCache;
   class Component;
   class ComponentNameVar;
   class Command;
   class ModifiedStatusVar;
   class NameVar;
   class Viewer;
+  class StateKey;
   class StateVar;
   class Tool;
 
@@ -52,14 +55,22 @@ namespace multidraw {
     void update() const;
   
     Component* component() const { return _component; }
-    virtual Viewer* viewer(int id = 0) const { return (id == 0) ? _viewer : nullptr; }
+    /// One of the views onto the component, such as occlusal, buccal or 3D, or nullptr.
+    virtual Viewer* viewer(int id = 0) const;
+    /// How many Viewers there are, counting any empty slots before the last.
+    virtual size_t viewers() const { return _viewers.size(); }
     Tool* tool() const { return _tool; }
     bool modified() const;
+    void modified(bool);
+    /// Where the document is saved.
+    std::string outpath() const;
+    void outpath(const std::string&);
     Command* command() const { return _command; }
     Fl_Window* window() const { return  _window; }
     
     void component(Component* comp) { _component = comp; }
-    virtual void viewer(Viewer* viewer, int id = 0) { if (id == 0) _viewer = viewer; }
+    /// Put a Viewer in a slot, or empty it with nullptr. Not owned.
+    virtual void viewer(Viewer*, int id = 0);
     void tool(Tool* tool) { _tool = tool; }
     void command(Command* cmd) { _command = cmd; }
     void window(Fl_Window* window) { _window = window; }
@@ -68,9 +79,15 @@ namespace multidraw {
     bool hasTool(Tool*);
     void removeTool(Tool*);
 
+    /// The State Variable for a key, or nullptr. Subscribe to it rather than polling.
+    StateVar* state(const StateKey&) const;
+    /// Looks the name up each call, without registering it; keep a StateKey where it is used often.
     StateVar* state(const std::string&) const;
 
     virtual int keystroke(int event);
+
+    /// The GPU buffers every Viewer of this Editor draws from.
+    std::shared_ptr<BufferCache> buffers();
     
   private:
     void init(Component*);
@@ -82,9 +99,13 @@ namespace multidraw {
     ComponentNameVar* _name;
     ModifiedStatusVar* _modified;
     NameVar* _outpath;
+    /// Indexed by StateKey::id.
+    std::vector<StateVar*> _states;
 
     Fl_Window* _window;
-    Viewer* _viewer;
+    std::vector<Viewer*> _viewers;
+    /// Held by the Viewers' renderers, which release it with the last of them.
+    std::weak_ptr<BufferCache> _buffers;
   };
 
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/FrameScheduler.hpp> // class implemented
+
+#include <algorithm>
+
+using namespace multidraw;
+
+const double FOREVER = 1e20;
+
+FrameScheduler::FrameScheduler(double budget) :
+  _budget(budget),
+  _all(false),
+  _requested(false),
+  _framing(false),
+  _start(),
+  _stats()
+{
+}// constructor
+
+void
+FrameScheduler::invalidate()
+{
+  if (pending()) {
+    _stats.skipped++;
+  }
+  _all = true;
+}// invalidate
+
+void
+FrameScheduler::invalidate(Viewer* viewer)
+{
+  if (pending()) {
+    _stats.skipped++;
+  }
+  _viewers.insert(viewer);
+}// invalidate
+
+void
+FrameScheduler::again(Viewer* viewer)
+{
+  if (_framing) {
+    _again.insert(viewer);
+  } else {
+    invalidate(viewer);
+  }
+}// again
+
+void
+FrameScheduler::request()
+{
+  if (pending()) {
+    _stats.skipped++;
+  }
+  _requested = true;
+}// request
+
+void
+FrameScheduler::hold(Viewer* viewer)
+{
+  if (std::find(_held.cbegin(), _held.cend(), viewer) == _held.cend()) {
+    _held.push_back(viewer);
+  }
+}// hold
+
+std::vector<Viewer*>
+FrameScheduler::release()
+{
+  std::vector<Viewer*> held;
+  held.swap(_held);
+  return held;
+}// release
+
+void
+FrameScheduler::forget(Viewer* viewer)
+{
+  _viewers.erase(viewer);
+  _again.erase(viewer);
+  _held.erase(std::remove(_held.begin(), _held.end(), viewer), _held.end());
+}// forget
+
+bool
+FrameScheduler::due() const
+{
+  return pending() && timeout() <= 0.0;
+}// due
+
+double
+FrameScheduler::timeout() const
+{
+  if (!pending()) {
+    return FOREVER;
+  }
+
+  std::chrono::duration<double> since = Clock::now() - _start;
+  return std::max(0.0, _budget - since.count());
+}// timeout
+
+void
+FrameScheduler::begin()
+{
+  _start = Clock::now();
+  _framing = true;
+}// begin
+
+void
+FrameScheduler::end()
+{
+  _all = false;
+  _requested = false;
+  _viewers.clear();
+  _viewers.swap(_again);
+  _framing = false;
+
+  std::chrono::duration<double> elapsed = Clock::now() - _start;
+  _stats.last = elapsed.count();
+  _stats.frames++;
+  if (_budget > 0.0 && _stats.last > _budget) {
+    _stats.dropped += (size_t)(_stats.last / _budget);
+  }
+}// end
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_FRAME_SCHEDULER_HPP
+#define LIBMULTIDRAW_FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <set>
+#include <vector>
+
+namespace multidraw {
+
+  class Viewer;
+
+  /**
+   * @brief Coalesces invalidations into at most one repaint per frame.
+   *
+   * Requests to update the whole application or a single Viewer are
+   * recorded, not acted on. Multidraw::run asks when the next frame is due
+   * and performs every pending update in one pass, so a burst of commands
+   * costs a single repaint. Viewers likewise hold back bursts of motion
+   * and wheel input, which are delivered once, just before the frame.
+   */
+  class FrameScheduler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+      /// Frames performed.
+      size_t frames;
+      /// Invalidations folded into an already pending frame.
+      size_t skipped;
+      /// Display frames missed because a frame ran over budget.
+      size_t dropped;
+      /// Duration of the most recent frame, in seconds.
+      double last;
+    };
+
+    FrameScheduler(double budget = 1.0 / 60);
+
+    /// Seconds available to each frame, i.e. the display interval.
+    double budget() const { return _budget; };
+    void budget(double seconds) { _budget = seconds; };
+
+    /// Request a repaint of every Editor.
+    void invalidate();
+    /// Request a repaint of one Viewer.
+    void invalidate(Viewer*);
+    /// Request a repaint of one Viewer in the next frame, even from within this one.
+    void again(Viewer*);
+    /// Request a frame that repaints only what is invalidated by then.
+    void request();
+    /// A Viewer holds coalesced input to deliver before the next frame.
+    void hold(Viewer*);
+    /// The Viewers holding input, each once. The caller delivers it.
+    std::vector<Viewer*> release();
+    /// Drop any pending request for a Viewer that is going away.
+    void forget(Viewer*);
+
+    bool pending() const { return _all || _requested || !_viewers.empty() || !_held.empty(); };
+    bool all() const { return _all; };
+    const std::set<Viewer*>& viewers() const { return _viewers; };
+
+    /// A frame is pending and the previous one was at least a budget ago.
+    bool due() const;
+    /// Seconds to wait for events before the next frame is due.
+    double timeout() const;
+
+    void begin();
+    void end();
+    bool framing() const { return _framing; };
+
+    const Stats& stats() const { return _stats; };
+
+  private:
+    double _budget;
+    bool _all;
+    bool _requested;
+    bool _framing;
+    std::set<Viewer*> _viewers;
+    /// Viewers to repaint in the frame after the current one.
+    std::set<Viewer*> _again;
+    std::vector<Viewer*> _held;
+    Clock::time_point _start;
+    Stats _stats;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_FRAME_SCHEDULER_HPP
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/Histogram.hpp> // class implemented
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using namespace multidraw;
+
+const double NANOSECONDS = 1E9;
+
+static size_t
+bucket(uint64_t nanos)
+{
+  if (nanos < 4) {
+    return nanos;
+  }
+  // Two bits below the leading one pick the quarter.
+  int width = std::bit_width(nanos);
+  return 4 * (width - 2) + ((nanos >> (width - 3)) & 3);
+}// bucket
+
+static uint64_t
+ceiling(size_t index)
+{
+  if (index < 4) {
+    return index;
+  }
+  int width = (int)(index / 4) + 2;
+  uint64_t quarter = (uint64_t)1 << (width - 3);
+  return (4 + index % 4) * quarter + (quarter - 1);
+}// ceiling
+
+Histogram::Histogram() :
+  _buckets(),
+  _count(0),
+  _total(0.0),
+  _max(0.0)
+{
+}// constructor
+
+void
+Histogram::add(double seconds)
+{
+  seconds = std::max(seconds, 0.0);
+  auto nanos = (uint64_t)std::min(seconds * NANOSECONDS, 1.8E19);
+  _buckets[std::min(bucket(nanos), BUCKETS - 1)]++;
+  _count++;
+  _total += seconds;
+  _max = std::max(_max, seconds);
+}// add
+
+void
+Histogram::clear()
+{
+  _buckets.fill(0);
+  _count = 0;
+  _total = 0.0;
+  _max = 0.0;
+}// clear
+
+double
+Histogram::percentile(double q) const
+{
+  if (_count == 0) {
+    return 0.0;
+  }
+
+  auto rank = (size_t)std::ceil(std::clamp(q, 0.0, 1.0) * _count);
+  size_t seen = 0;
+  for (size_t index = 0; index < BUCKETS; index++) {
+    seen += _buckets[index];
+    if (seen >= std::max(rank, (size_t)1)) {
+      // The top of the bucket, but never more than was actually seen.
+      return std::min(ceiling(index) / NANOSECONDS, _max);
+    }
+  }
+  return _max;
+}// percentile
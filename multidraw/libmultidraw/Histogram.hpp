@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_HISTOGRAM_HPP
+#define LIBMULTIDRAW_HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace multidraw {
+
+  /**
+   * @brief A distribution of durations in fixed memory.
+   *
+   * Durations are counted in nanosecond buckets, four to each power of
+   * two, so a percentile is accurate to within a quarter of its value.
+   * Adding never allocates.
+   */
+  class Histogram {
+  public:
+    static const size_t BUCKETS = 252;
+
+    Histogram();
+
+    void add(double seconds);
+    void clear();
+
+    size_t count() const { return _count; };
+    /// Sum of all durations added, in seconds.
+    double total() const { return _total; };
+    double max() const { return _max; };
+    double mean() const { return _count == 0 ? 0.0 : _total / _count; };
+
+    /// The duration, in seconds, that a fraction q of those added did not exceed.
+    double percentile(double q) const;
+
+  private:
+    std::array<size_t, BUCKETS> _buckets;
+    size_t _count;
+    double _total;
+    double _max;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_HISTOGRAM_HPP
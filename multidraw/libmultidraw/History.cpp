@@ -0,0 +1,532 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/History.hpp> // class implemented
+
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <system_error>
+#include <typeinfo>
+
+using namespace multidraw;
+
+using Clock = std::chrono::steady_clock;
+
+const double INTERVAL = 0.05;
+
+static double
+seconds(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}// seconds
+
+History::History(size_t budget) :
+  _base(0),
+  _spilled(0),
+  _open(false),
+  _logged(),
+  _budget(budget),
+  _spill_budget(SPILL_BUDGET),
+  _root(nullptr),
+  _checkpointing(false),
+  _interval(INTERVAL),
+  _since(0.0),
+  _restore(0.0),
+  _stats()
+{
+}// constructor
+
+History::~History()
+{
+  if (_file.is_open()) {
+    _file.close();
+    std::error_code error;
+    std::filesystem::remove(_path, error);
+  }
+}// destructor
+
+void
+History::budget(size_t bytes)
+{
+  _budget = bytes;
+  enforce();
+}// budget
+
+void
+History::checkpointing(bool checkpointing)
+{
+  _checkpointing = checkpointing;
+  if (_checkpointing) {
+    checkpoint();
+  } else {
+    _checkpoints.clear();
+    _stats.checkpoints = 0;
+  }
+}// checkpointing
+
+void
+History::push(std::unique_ptr<Command> cmd, double cost)
+{
+  for (auto& entry : _future) {
+    discard(entry);
+  }
+  _future.clear();
+  while (!_checkpoints.empty() && _checkpoints.back().position > position()) {
+    _checkpoints.pop_back();
+  }
+  _stats.checkpoints = _checkpoints.size();
+
+  _past.push_back(Entry{std::move(cmd), LIVE, 0, 0, cost});
+  _stats.entries++;
+  measure(_past.back());
+  _open = true;
+  _logged = Clock::now();
+
+  _since += cost;
+  if (_checkpointing && _since >= _interval) {
+    checkpoint();
+  }
+
+  enforce();
+}// push
+
+bool
+History::merge(const Command& cmd, double window, double cost)
+{
+  if (!_open || !_future.empty() || _past.empty()) {
+    return false;
+  }
+
+  auto now = Clock::now();
+  if (std::chrono::duration<double>(now - _logged).count() > window) {
+    return false;
+  }
+
+  // The most recent command is hot, so it is live.
+  Entry& entry = _past.back();
+  Command& last = *entry.command;
+  if (typeid(last) != typeid(cmd) ||
+      last.editor() != cmd.editor() ||
+      !std::ranges::equal(last.clipboard(), cmd.clipboard()) ||
+      !last.merge(cmd)) {
+    return false;
+  }
+
+  entry.cost += cost;
+  measure(entry);
+  _logged = now;
+  _stats.merged++;
+
+  // A checkpoint of the present no longer matches it.
+  _since += cost;
+  if (_checkpointing &&
+      ((!_checkpoints.empty() && _checkpoints.back().position == position()) ||
+       _since >= _interval)) {
+    checkpoint();
+  }
+
+  enforce();
+  return true;
+}// merge
+
+size_t
+History::undo(size_t steps)
+{
+  steps = std::min(steps, _past.size());
+  if (steps == 0) {
+    return 0;
+  }
+
+  size_t target = position() - steps;
+
+  const Checkpoint* from = nearest(_base + _spilled, target);
+  if (from != nullptr && _restore + cost(from->position, target) < cost(target, position())) {
+    restore(*from);
+    for (size_t next = from->position; next < target; next++) {
+      replay(at(next), true);
+      _stats.replayed++;
+    }
+
+    // The restored state already lacks these; they only change sides.
+    while (position() > target) {
+      _future.push_back(std::move(_past.back()));
+      _past.pop_back();
+    }
+    _open = false;
+    enforce();
+    return steps;
+  }
+
+  size_t step = 0;
+  while (step < steps && undoable() != nullptr) {
+    replay(_past.back(), false);
+    undone();
+    step++;
+  }
+  return step;
+}// undo
+
+size_t
+History::redo(size_t steps)
+{
+  steps = std::min(steps, _future.size());
+  if (steps == 0) {
+    return 0;
+  }
+
+  size_t target = position() + steps;
+
+  const Checkpoint* from = nearest(position() + 1, target);
+  if (from != nullptr && _restore + cost(from->position, target) < cost(position(), target)) {
+    size_t restored = from->position;
+    restore(*from);
+
+    // The restored state already includes these; they only change sides.
+    while (position() < restored) {
+      _past.push_back(std::move(_future.back()));
+      _future.pop_back();
+    }
+    _open = false;
+    enforce();
+  }
+
+  while (position() < target) {
+    redoable();
+    replay(_future.back(), true);
+    redone();
+  }
+  return steps;
+}// redo
+
+Command*
+History::undoable()
+{
+  if (_past.empty()) {
+    return nullptr;
+  }
+
+  Entry& entry = _past.back();
+
+  if (entry.state == SPILLED) {
+    _file.clear();
+    _file.seekg(entry.offset);
+    if (!entry.command->unspill(_file)) {
+      // The history ends here.
+      evict(_past.size());
+      return nullptr;
+    }
+    entry.state = COMPRESSED;
+    _stats.compressed++;
+    _stats.spilled--;
+    _spilled--;
+  }
+
+  decompress(entry);
+  measure(entry);
+  if (_spilled == 0) {
+    evict(0);
+  }
+
+  return entry.command.get();
+}// undoable
+
+void
+History::undone()
+{
+  _open = false;
+  if (!_past.empty()) {
+    _future.push_back(std::move(_past.back()));
+    _past.pop_back();
+    measure(_future.back());
+  }
+}// undone
+
+Command*
+History::redoable()
+{
+  if (_future.empty()) {
+    return nullptr;
+  }
+
+  // A jump may have moved compressed commands here.
+  Entry& entry = _future.back();
+  decompress(entry);
+  measure(entry);
+  return entry.command.get();
+}// redoable
+
+void
+History::redone()
+{
+  _open = false;
+  if (!_future.empty()) {
+    _past.push_back(std::move(_future.back()));
+    _future.pop_back();
+    measure(_past.back());
+    enforce();
+  }
+}// redone
+
+void
+History::clear()
+{
+  for (auto& entry : _future) {
+    discard(entry);
+  }
+  _future.clear();
+  _open = false;
+
+  // Clearing is not eviction.
+  size_t evicted = _stats.evicted;
+  evict(_past.size());
+  _stats.evicted = evicted;
+
+  _checkpoints.clear();
+  _stats.checkpoints = 0;
+  if (_checkpointing) {
+    checkpoint();
+  }
+}// clear
+
+History::Entry&
+History::at(size_t position)
+{
+  if (position < this->position()) {
+    return _past[position - _base];
+  }
+  return _future[_future.size() - 1 - (position - this->position())];
+}// at
+
+double
+History::cost(size_t first, size_t last)
+{
+  double cost = 0.0;
+  for (size_t next = first; next < last; next++) {
+    cost += at(next).cost;
+  }
+  return cost;
+}// cost
+
+const History::Checkpoint*
+History::nearest(size_t first, size_t last) const
+{
+  // The latest checkpoint no later than last.
+  auto iter = std::upper_bound(_checkpoints.cbegin(), _checkpoints.cend(), last,
+                               [](size_t position, const Checkpoint& checkpoint) {
+                                 return position < checkpoint.position;
+                               });
+  if (iter == _checkpoints.cbegin() || (--iter)->position < first) {
+    return nullptr;
+  }
+  return &*iter;
+}// nearest
+
+void
+History::checkpoint()
+{
+  if (_root == nullptr) {
+    return;
+  }
+
+  auto start = Clock::now();
+  Checkpoint checkpoint{position(), _root->snapshot()};
+  if (_restore == 0.0) {
+    // Restoring visits what taking visited; a fair first estimate.
+    _restore = seconds(start);
+  }
+
+  auto iter = std::lower_bound(_checkpoints.begin(), _checkpoints.end(), checkpoint.position,
+                               [](const Checkpoint& checkpoint, size_t position) {
+                                 return checkpoint.position < position;
+                               });
+  if (iter != _checkpoints.end() && iter->position == checkpoint.position) {
+    *iter = std::move(checkpoint);
+  } else {
+    _checkpoints.insert(iter, std::move(checkpoint));
+  }
+
+  _since = 0.0;
+  _stats.checkpoints = _checkpoints.size();
+}// checkpoint
+
+void
+History::restore(const Checkpoint& checkpoint)
+{
+  auto start = Clock::now();
+  _root->restore(checkpoint.state);
+  _restore = seconds(start);
+  _stats.restored++;
+}// restore
+
+double
+History::replay(Entry& entry, bool forward)
+{
+  bool compressed = entry.state == COMPRESSED;
+  decompress(entry);
+
+  auto start = Clock::now();
+  if (forward) {
+    entry.command->execute();
+  } else {
+    entry.command->unexecute();
+  }
+  entry.cost = seconds(start);
+
+  if (compressed) {
+    entry.command->compress();
+    entry.state = COMPRESSED;
+    _stats.compressed++;
+  }
+  measure(entry);
+
+  return entry.cost;
+}// replay
+
+void
+History::measure(Entry& entry)
+{
+  _stats.bytes -= entry.bytes;
+  entry.bytes = entry.command->bytes();
+  _stats.bytes += entry.bytes;
+  _stats.peak = std::max(_stats.peak, _stats.bytes);
+}// measure
+
+void
+History::enforce()
+{
+  size_t cold = _past.size() > HOT ? _past.size() - HOT : 0;
+
+  // Everything older than the first already compressed command was
+  // compressed when it left the hot window.
+  for (size_t i = cold; i > _spilled && _past[i - 1].state == LIVE; i--) {
+    Entry& entry = _past[i - 1];
+    entry.command->compress();
+    entry.state = COMPRESSED;
+    _stats.compressed++;
+    measure(entry);
+  }
+
+  while (_stats.bytes > _budget && _spilled < cold) {
+    if (spill(_past[_spilled])) {
+      _spilled++;
+    } else {
+      evict(_spilled + 1);
+      cold = _past.size() > HOT ? _past.size() - HOT : 0;
+    }
+  }
+
+  // Replaying from a checkpoint needs every command after it in memory.
+  while (!_checkpoints.empty() && _checkpoints.front().position < _base + _spilled) {
+    _checkpoints.pop_front();
+  }
+  _stats.checkpoints = _checkpoints.size();
+}// enforce
+
+bool
+History::spill(Entry& entry)
+{
+  if (_stats.disk >= _spill_budget) {
+    return false;
+  }
+
+  if (!_file.is_open()) {
+    std::random_device random;
+    std::error_code error;
+    _path = std::filesystem::temp_directory_path(error) /
+      ("multidraw-history-" + std::to_string(random()));
+    _file.open(_path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!_file.is_open()) {
+      return false;
+    }
+  }
+
+  _file.clear();
+  _file.seekp(0, std::ios::end);
+  entry.offset = _file.tellp();
+  bool spilled = entry.command->spill(_file) && _file.good();
+  _file.clear();
+  _file.seekp(0, std::ios::end);
+  _stats.disk = (size_t)_file.tellp();
+  if (!spilled) {
+    return false;
+  }
+
+  // Only cold commands are spilled, and those are all compressed.
+  entry.state = SPILLED;
+  _stats.compressed--;
+  _stats.spilled++;
+  measure(entry);
+  return true;
+}// spill
+
+void
+History::evict(size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    Entry& entry = _past.front();
+    if (entry.state == SPILLED) {
+      _spilled--;
+    }
+    discard(entry);
+    _past.pop_front();
+    _base++;
+    _stats.evicted++;
+  }
+
+  if (_spilled == 0 && _stats.disk > 0) {
+    // Nothing in the file is needed any more; reuse it from the start.
+    _file.close();
+    _file.open(_path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    _stats.disk = 0;
+  }
+
+  while (!_checkpoints.empty() && _checkpoints.front().position < _base) {
+    _checkpoints.pop_front();
+  }
+  _stats.checkpoints = _checkpoints.size();
+}// evict
+
+void
+History::discard(Entry& entry)
+{
+  if (entry.state == COMPRESSED) {
+    _stats.compressed--;
+  } else if (entry.state == SPILLED) {
+    _stats.spilled--;
+  }
+  _stats.bytes -= entry.bytes;
+  _stats.entries--;
+}// discard
+
+void
+History::decompress(Entry& entry)
+{
+  if (entry.state == COMPRESSED) {
+    entry.command->decompress();
+    entry.state = LIVE;
+    _stats.compressed--;
+  }
+}// decompress
@@ -1,17 +1,182 @@
 #ifndef LIBMULTIDRAW_HISTORY_HPP
 #define LIBMULTIDRAW_HISTORY_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <vector>
 
+#include <libmultidraw/Ring.hpp>
 #include <libmultidraw/commands/Command.hpp>
 
 namespace multidraw {
 
+  class Component;
+  class Snapshot;
+
+  /**
+   * @brief The undo and redo stacks of one document, held within a memory budget.
+   *
+   * The newest HOT commands are kept as they are. Older commands are
+   * compressed. While the bytes retained exceed the budget, the oldest
+   * commands are spilled to a temporary file or, when they cannot be,
+   * evicted together with everything older.
+   *
+   * With checkpointing on, a Snapshot of the document is kept whenever
+   * the commands run since the last one took interval() seconds. A jump
+   * of many steps restores the nearest checkpoint and replays at most
+   * about that much work, when that is cheaper than stepping.
+   */
   class History {
-   public:
-    std::vector<std::unique_ptr<Command>> past;
-    std::vector<std::unique_ptr<Command>> future;
+  public:
+    /// Commands nearest the present that are never compressed, spilled or evicted.
+    static const size_t HOT = 16;
+    static const size_t BUDGET = size_t(256) << 20;
+    static const size_t SPILL_BUDGET = size_t(4) << 30;
+
+    struct Stats {
+      /// Commands in the past and the future.
+      size_t entries;
+      /// Bytes retained in memory, as reported by Command::bytes.
+      size_t bytes;
+      /// Highest value of bytes.
+      size_t peak;
+      /// Commands currently compressed.
+      size_t compressed;
+      /// Commands currently in the spill file.
+      size_t spilled;
+      /// Bytes written to the spill file.
+      size_t disk;
+      /// Commands dropped from the past since construction.
+      size_t evicted;
+      /// Commands folded into the one before them.
+      size_t merged;
+      /// Checkpoints currently held.
+      size_t checkpoints;
+      /// Jumps that started from a checkpoint.
+      size_t restored;
+      /// Commands executed to bring a restored checkpoint up to date.
+      size_t replayed;
+    };
+
+    History(size_t budget = BUDGET);
+    ~History();
+
+    History(const History&) = delete;
+    History& operator=(const History&) = delete;
+
+    size_t budget() const { return _budget; };
+    void budget(size_t bytes);
+
+    /// Size of the spill file at which spilled commands are evicted. Zero never spills.
+    size_t spill_budget() const { return _spill_budget; };
+    void spill_budget(size_t bytes) { _spill_budget = bytes; };
+
+    /// The document's root Component, needed for checkpoints.
+    Component* root() const { return _root; };
+    void root(Component* comp) { _root = comp; };
+
+    bool checkpointing() const { return _checkpointing; };
+    /// Turning checkpoints on takes one of the present state.
+    void checkpointing(bool);
+    /// Seconds of command execution between checkpoints.
+    double interval() const { return _interval; };
+    void interval(double seconds) { _interval = seconds; };
+
+    size_t past_size() const { return _past.size(); };
+    size_t future_size() const { return _future.size(); };
+
+    /// Record a command that has been executed, taking cost seconds. Drops the future.
+    void push(std::unique_ptr<Command>, double cost = 0.0);
+
+    /**
+     * Fold a command into the most recent one, if that was recorded or
+     * merged at most window seconds ago and has not been sealed since.
+     * The caller keeps ownership of the command.
+     */
+    bool merge(const Command&, double window, double cost = 0.0);
+    /// Stop the most recent command from absorbing any more.
+    void seal() { _open = false; };
+
+    /// Revert up to steps commands. Returns the number reverted.
+    size_t undo(size_t steps);
+    /// Reapply up to steps commands. Returns the number reapplied.
+    size_t redo(size_t steps);
+
+    /// The command an undo would unexecute, ready to run, or nullptr.
+    Command* undoable();
+    /// Move the command returned by undoable() to the future.
+    void undone();
+
+    /// The command a redo would execute, ready to run, or nullptr.
+    Command* redoable();
+    /// Move the command returned by redoable() to the past.
+    void redone();
+
+    void clear();
+
+    const Stats& stats() const { return _stats; };
+
+  private:
+    enum State { LIVE, COMPRESSED, SPILLED };
+
+    struct Entry {
+      std::unique_ptr<Command> command;
+      State state;
+      size_t bytes;
+      std::streamoff offset;
+      /// Seconds the command last took to run.
+      double cost;
+    };
+
+    struct Checkpoint {
+      /// Commands applied since the History began.
+      size_t position;
+      std::shared_ptr<const Snapshot> state;
+    };
+
+    size_t position() const { return _base + _past.size(); };
+    Entry& at(size_t position);
+    double cost(size_t first, size_t last);
+    const Checkpoint* nearest(size_t first, size_t last) const;
+
+    void checkpoint();
+    void restore(const Checkpoint&);
+    double replay(Entry&, bool forward);
+
+    void measure(Entry&);
+    void enforce();
+    bool spill(Entry&);
+    void evict(size_t count);
+    void discard(Entry&);
+    void decompress(Entry&);
+
+    Ring<Entry> _past;
+    std::vector<Entry> _future;
+    /// Position of the oldest command in the past.
+    size_t _base;
+    /// The spilled commands are always the oldest ones in the past.
+    size_t _spilled;
+    bool _open;
+    std::chrono::steady_clock::time_point _logged;
+    size_t _budget;
+    size_t _spill_budget;
+    std::filesystem::path _path;
+    std::fstream _file;
+
+    Component* _root;
+    bool _checkpointing;
+    double _interval;
+    /// Seconds of commands pushed since the newest checkpoint.
+    double _since;
+    /// Seconds the last checkpoint took to take or restore.
+    double _restore;
+    std::deque<Checkpoint> _checkpoints;
+
+    Stats _stats;
   };
 
 }
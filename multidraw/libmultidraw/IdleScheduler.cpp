@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/IdleScheduler.hpp> // class implemented
+
+#include <algorithm>
+
+using namespace multidraw;
+
+IdleScheduler::IdleScheduler(double budget) :
+  _budget(budget),
+  _next(0),
+  _stats()
+{
+}// constructor
+
+IdleScheduler::Id
+IdleScheduler::post(Task task, Priority priority)
+{
+  Id id = ++_next;
+  _queues[priority].push_back(Entry{id, std::move(task)});
+  _stats.posted++;
+  _stats.peak = std::max(_stats.peak, size());
+  return id;
+}// post
+
+bool
+IdleScheduler::cancel(Id id)
+{
+  for (auto& queue : _queues) {
+    auto iter = std::find_if(queue.begin(), queue.end(), [id](const Entry& entry) { return entry.id == id; });
+    if (iter != queue.end()) {
+      queue.erase(iter);
+      _stats.cancelled++;
+      return true;
+    }
+  }
+  return false;
+}// cancel
+
+size_t
+IdleScheduler::size() const
+{
+  size_t size = 0;
+  for (const auto& queue : _queues) {
+    size += queue.size();
+  }
+  return size;
+}// size
+
+bool
+IdleScheduler::run(Clock::time_point deadline, size_t least)
+{
+  _stats.last = 0.0;
+
+  auto now = Clock::now();
+  for (size_t slice = 0; slice < least || now < deadline; slice++) {
+    auto queue = std::find_if(_queues.begin(), _queues.end(), [](const auto& queue) { return !queue.empty(); });
+    if (queue == _queues.end()) {
+      break;
+    }
+
+    // Off the queue while it runs, so a task that throws or posts is safe.
+    Entry entry = std::move(queue->front());
+    queue->pop_front();
+
+    auto start = now;
+    bool finished = entry.task(deadline);
+    now = Clock::now();
+
+    std::chrono::duration<double> spent = now - start;
+    _stats.spent += spent.count();
+    _stats.last += spent.count();
+    _stats.slices++;
+    if (now > deadline) {
+      _stats.overruns++;
+    }
+
+    if (finished) {
+      _stats.finished++;
+    } else {
+      // Behind the others of its priority, so they take turns.
+      queue->push_back(std::move(entry));
+    }
+  }
+
+  return !empty();
+}// run
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_IDLE_SCHEDULER_HPP
+#define LIBMULTIDRAW_IDLE_SCHEDULER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace multidraw {
+
+  /**
+   * @brief Background work done in slices while the event loop has nothing else to do.
+   *
+   * A task is called with a deadline. It does some work, returns before
+   * the deadline when it can, and returns true once it is finished.
+   * Until then it is called again on later passes, so work such as BVH
+   * refits or autosave encoding can be spread over many idle moments.
+   * Multidraw::run gives the scheduler at most budget() seconds a pass,
+   * and never more than is left before the next frame is due. More
+   * urgent tasks run first, and tasks of the same priority take turns.
+   */
+  class IdleScheduler {
+  public:
+    using Clock = std::chrono::steady_clock;
+    /// Does a slice of work before the deadline. Returns true when finished.
+    using Task = std::function<bool(Clock::time_point deadline)>;
+    using Id = uint64_t;
+
+    enum Priority { HIGH, NORMAL, LOW, PRIORITIES };
+
+    struct Stats {
+      /// Tasks posted.
+      size_t posted;
+      /// Tasks that returned true.
+      size_t finished;
+      /// Tasks cancelled before they finished.
+      size_t cancelled;
+      /// Calls made to tasks.
+      size_t slices;
+      /// Slices that returned after their deadline.
+      size_t overruns;
+      /// Most tasks queued at once.
+      size_t peak;
+      /// Seconds spent in tasks since construction.
+      double spent;
+      /// Seconds spent in tasks on the most recent pass.
+      double last;
+    };
+
+    IdleScheduler(double budget = 0.004);
+
+    IdleScheduler(const IdleScheduler&) = delete;
+    IdleScheduler& operator=(const IdleScheduler&) = delete;
+
+    /// Seconds of tasks to run each time the event loop goes idle.
+    double budget() const { return _budget; };
+    void budget(double seconds) { _budget = seconds; };
+
+    /// Queue a task. The id can cancel it until it finishes.
+    Id post(Task, Priority = NORMAL);
+    /// Drop a queued task. False if it has already finished.
+    bool cancel(Id);
+
+    bool empty() const { return size() == 0; };
+    /// Tasks queued.
+    size_t size() const;
+    /// Tasks queued at one priority.
+    size_t size(Priority priority) const { return _queues[priority].size(); };
+
+    /**
+     * Run slices of tasks until the deadline or until none remain, but
+     * at least the given number of slices. True if any remain.
+     */
+    bool run(Clock::time_point deadline, size_t least = 0);
+
+    const Stats& stats() const { return _stats; };
+
+  private:
+    struct Entry {
+      Id id;
+      Task task;
+    };
+
+    double _budget;
+    std::array<std::deque<Entry>, PRIORITIES> _queues;
+    Id _next;
+    Stats _stats;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_IDLE_SCHEDULER_HPP
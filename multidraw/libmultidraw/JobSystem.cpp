@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/JobSystem.hpp> // class implemented
+
+#include <algorithm>
+#include <chrono>
+
+using namespace multidraw;
+
+/// How long a joining thread with nothing to run sleeps before looking again.
+const std::chrono::microseconds NAP(100);
+
+/// The JobSystem a thread works for, and its index there.
+static thread_local const JobSystem* current = nullptr;
+static thread_local size_t worker = 0;
+
+JobSystem::Group::Group() :
+  _state(std::make_shared<State>())
+{
+}// constructor
+
+bool
+JobSystem::Group::done() const
+{
+  return _state->pending == 0;
+}// done
+
+JobSystem::JobSystem(size_t threads) :
+  _count(std::max(threads, (size_t)1) - 1),
+  _queued(0),
+  _stopping(false),
+  _posted(nullptr),
+  _posts(0)
+{
+  for (size_t index = 0; index < _count + 2; index++) {
+    _queues.push_back(std::make_unique<Queue>());
+  }
+  _workers.reserve(_count);
+  for (size_t index = 0; index < _count; index++) {
+    _workers.emplace_back(&JobSystem::work, this, index);
+  }
+}// constructor
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(_sleep);
+    _stopping = true;
+  }
+  _idle.notify_all();
+
+  for (auto& thread : _workers) {
+    thread.join();
+  }
+
+  Posted* posted = _posted.exchange(nullptr);
+  while (posted != nullptr) {
+    Posted* next = posted->next;
+    delete posted;
+    posted = next;
+  }
+}// destructor
+
+void
+JobSystem::spawn(Job job)
+{
+  if (_count == 0) {
+    job();
+    return;
+  }
+  push(_count + 1, std::move(job));
+}// spawn
+
+void
+JobSystem::fork(Group& group, Job job)
+{
+  std::shared_ptr<Group::State> state = group._state;
+  state->pending++;
+
+  size_t queue = current == this ? worker : _count;
+  push(queue, [this, state, job = std::move(job)] {
+    try {
+      job();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (!state->error) {
+        state->error = std::current_exception();
+      }
+    }
+    finish(state);
+  });
+}// fork
+
+void
+JobSystem::join(Group& group)
+{
+  Group::State& state = *group._state;
+  size_t self = current == this ? worker : _count;
+
+  while (state.pending > 0) {
+    Job job;
+    if (take(self, job)) {
+      job();
+    } else {
+      // What is left runs elsewhere.
+      std::unique_lock<std::mutex> lock(state.mutex);
+      state.finished.wait_for(lock, NAP, [&state] { return state.pending == 0; });
+    }
+  }
+
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::swap(error, state.error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}// join
+
+void
+JobSystem::then(Group& group, Job job)
+{
+  Group::State& state = *group._state;
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.pending > 0) {
+      state.continuations.push_back(std::move(job));
+      return;
+    }
+  }
+  spawn(std::move(job));
+}// then
+
+void
+JobSystem::parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+  if (count == 0) {
+    return;
+  }
+
+  // Helpers pull indices as they go, so uneven calls balance themselves.
+  std::atomic<size_t> next(0);
+  auto drain = [&] {
+    for (size_t index = next++; index < count; index = next++) {
+      task(index);
+    }
+  };
+
+  Group group;
+  size_t helpers = std::min(count, size()) - 1;
+  for (size_t helper = 0; helper < helpers; helper++) {
+    fork(group, drain);
+  }
+
+  try {
+    drain();
+  } catch (...) {
+    // The helpers still refer to this frame.
+    next = count;
+    try {
+      join(group);
+    } catch (...) {
+    }
+    throw;
+  }
+  join(group);
+}// parallel_for
+
+void
+JobSystem::post(Job job)
+{
+  auto* node = new Posted{std::move(job), _posted.load(std::memory_order_relaxed)};
+  while (!_posted.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+  }
+
+  _posts.fetch_add(1, std::memory_order_release);
+  _posts.notify_all();
+  if (_wake) {
+    _wake();
+  }
+}// post
+
+size_t
+JobSystem::complete()
+{
+  Posted* posted = _posted.exchange(nullptr, std::memory_order_acquire);
+  if (posted == nullptr) {
+    return 0;
+  }
+
+  // Newest first on the stack; run them in the order they were posted.
+  std::vector<Job> jobs;
+  while (posted != nullptr) {
+    jobs.push_back(std::move(posted->job));
+    Posted* next = posted->next;
+    delete posted;
+    posted = next;
+  }
+  for (auto job = jobs.rbegin(); job != jobs.rend(); job++) {
+    (*job)();
+  }
+  return jobs.size();
+}// complete
+
+void
+JobSystem::await()
+{
+  // A post after this load changes the count, so the wait cannot miss it.
+  uint64_t seen = _posts.load(std::memory_order_acquire);
+  if (_posted.load(std::memory_order_acquire) == nullptr) {
+    _posts.wait(seen, std::memory_order_acquire);
+  }
+}// await
+
+void
+JobSystem::work(size_t index)
+{
+  current = this;
+  worker = index;
+
+  Queue& detached = *_queues[_count + 1];
+  while (true) {
+    Job job;
+    if (take(index, job) || (!_stopping && take(detached, false, job))) {
+      job();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_sleep);
+    _idle.wait(lock, [this] { return _stopping || _queued > 0; });
+    if (_stopping && _queued == 0) {
+      return;
+    }
+    if (_stopping) {
+      // Forked jobs are finished, since someone is joining them; detached ones are dropped.
+      lock.unlock();
+      if (!take(index, job)) {
+        return;
+      }
+      job();
+    }
+  }
+}// work
+
+void
+JobSystem::push(size_t queue, Job job)
+{
+  {
+    std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+    _queues[queue]->jobs.push_back(std::move(job));
+  }
+  _queued++;
+  notify();
+}// push
+
+void
+JobSystem::notify()
+{
+  // Taking the lock orders this against a worker about to sleep.
+  {
+    std::lock_guard<std::mutex> lock(_sleep);
+  }
+  _idle.notify_one();
+}// notify
+
+bool
+JobSystem::take(size_t self, Job& job)
+{
+  size_t workers = _count;
+  if (self < workers && take(*_queues[self], true, job)) {
+    return true;
+  }
+  // Other threads fork onto the shared deque, so it is theirs to take newest first.
+  if (take(*_queues[workers], self == workers, job)) {
+    return true;
+  }
+  for (size_t offset = 1; offset <= workers; offset++) {
+    size_t victim = (self + offset) % workers;
+    if (victim != self && take(*_queues[victim], false, job)) {
+      return true;
+    }
+  }
+  return false;
+}// take
+
+bool
+JobSystem::take(Queue& queue, bool newest, Job& job)
+{
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.jobs.empty()) {
+    return false;
+  }
+  if (newest) {
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+  } else {
+    job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+  }
+  _queued--;
+  return true;
+}// take
+
+void
+JobSystem::finish(const std::shared_ptr<Group::State>& state)
+{
+  std::vector<Job> continuations;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (--state->pending > 0) {
+      return;
+    }
+    continuations.swap(state->continuations);
+  }
+  state->finished.notify_all();
+
+  for (auto& job : continuations) {
+    spawn(std::move(job));
+  }
+}// finish
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_JOB_SYSTEM_HPP
+#define LIBMULTIDRAW_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace multidraw {
+
+  /**
+   * @brief Worker threads shared by everything in the library that runs in parallel.
+   *
+   * Forked jobs go on the deque of the worker that forks them, or on a
+   * shared deque when forked from another thread. Threads take their
+   * own newest job first and steal the oldest from the others. A thread
+   * that joins a Group runs forked jobs while it waits, so fork and join
+   * nest, even on the workers themselves. Detached jobs, such as
+   * AsyncCmd computations, run only on workers, and only when there are
+   * no forked jobs; a thread joining never picks one up.
+   *
+   * Results go back to the main thread through post(). Posting never
+   * takes a lock. The main loop runs what was posted with complete().
+   */
+  class JobSystem {
+  public:
+    using Job = std::function<void()>;
+
+    /// Jobs forked together, to be joined or continued as one.
+    class Group {
+    public:
+      Group();
+
+      /// Every job forked into the group has finished.
+      bool done() const;
+
+    private:
+      friend class JobSystem;
+
+      struct State {
+        std::atomic<size_t> pending;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::vector<Job> continuations;
+        std::exception_ptr error;
+      };
+
+      std::shared_ptr<State> _state;
+    };
+
+    /// Threads, counting the one that forks. One or fewer runs everything on the caller.
+    explicit JobSystem(size_t threads = std::thread::hardware_concurrency());
+    /// Waits for running jobs. Queued detached jobs and posted results are dropped.
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /// Threads taking part in a parallel_for, counting the caller.
+    size_t size() const { return _count + 1; };
+
+    /// Run a job on a worker, not waited for. With no workers, runs it now. It must not throw.
+    void spawn(Job);
+
+    /// Run a job as part of a Group.
+    void fork(Group&, Job);
+    /// Return once every job in the Group has, rethrowing the first exception one threw.
+    void join(Group&);
+    /// Spawn a job once every job in the Group has finished; now, if they have.
+    void then(Group&, Job);
+
+    /**
+     * Call task(index) for every index in [0, count), spread over the
+     * workers and the calling thread. Returns once every call has.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+    /// Hand a job to the main thread. Safe from any thread.
+    void post(Job);
+    /// On the main thread, run every job posted so far. Returns how many ran.
+    size_t complete();
+    /// Block until a job has been posted and not yet completed.
+    void await();
+    /// Called after every post(), e.g. to wake an event loop. Set before anything is posted.
+    void wake(std::function<void()> wake) { _wake = std::move(wake); };
+
+  private:
+    struct Queue {
+      std::mutex mutex;
+      std::deque<Job> jobs;
+    };
+
+    struct Posted {
+      Job job;
+      Posted* next;
+    };
+
+    void work(size_t index);
+    void push(size_t queue, Job);
+    void notify();
+    /// A forked job for a thread, taking its own newest or another's oldest.
+    bool take(size_t self, Job&);
+    bool take(Queue&, bool newest, Job&);
+    void finish(const std::shared_ptr<Group::State>&);
+
+    /// Workers, fixed before any starts.
+    const size_t _count;
+    /// One per worker, then one for other threads, then the detached jobs.
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<size_t> _queued;
+    std::mutex _sleep;
+    std::condition_variable _idle;
+    std::atomic<bool> _stopping;
+
+    std::atomic<Posted*> _posted;
+    std::atomic<uint64_t> _posts;
+    std::function<void()> _wake;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_JOB_SYSTEM_HPP
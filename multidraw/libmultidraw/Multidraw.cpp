@@ -23,17 +23,45 @@
 #include <libmultidraw/Multidraw.hpp> // class implemented
 
 #include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Constraint.hpp>
 #include <libmultidraw/Editor.hpp>
 #include <libmultidraw/History.hpp>
+#include <libmultidraw/Recorder.hpp>
+#include <libmultidraw/Viewer.hpp>
+#include <libmultidraw/commands/AsyncCmd.hpp>
 #include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/commands/MacroCmd.hpp>
+#include <libmultidraw/commands/RedoCmd.hpp>
+#include <libmultidraw/commands/UndoCmd.hpp>
 #include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+#include <libmultidraw/state_vars/StateVar.hpp>
 
 #include <FL/Fl.H>
 
-const double FOREVER = 1e20;
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
 
 using namespace multidraw;
 
+const double MERGE_WINDOW = 0.5;
+/// Longer than any wait, for FLTK to return only on an event.
+const double FOREVER = 1e20;
+
+/// Whether inner is outer or lies below it.
+static bool
+contains(const Component* outer, const Component* inner)
+{
+  for (const Component* comp = inner; comp != nullptr; comp = comp->parent()) {
+    if (comp == outer) {
+      return true;
+    }
+  }
+  return false;
+}// contains
+
 Multidraw* Multidraw::_instance = nullptr;
 
 Multidraw*
@@ -46,13 +74,41 @@ Multidraw::instance()
   return _instance;
 }// instance
 
-Multidraw::Multidraw()
+Multidraw::Multidraw() :
+  _headless(false),
+  _gestures(0),
+  _merge_window(MERGE_WINDOW),
+  _cost(0.0),
+  _recorder(nullptr),
+  // At least one worker, so the main thread is never the one computing.
+  _jobs(new JobSystem(std::max(2U, std::thread::hardware_concurrency())))
 {
+  // Workers hand results back through the event loop.
+  _jobs->wake([this] {
+    if (!_headless) {
+      Fl::awake();
+    }
+  });
+
   init(nullptr);
 }// constructor
 
 Multidraw::~Multidraw()
 {
+  for (auto* cmd : _asyncs) {
+    cmd->cancel();
+  }
+  _jobs.reset();
+  for (auto* cmd : _asyncs) {
+    delete cmd;
+  }
+  _asyncs.clear();
+
+  for (auto* macro : _transactions) {
+    delete macro;
+  }
+  _transactions.clear();
+
   delete _catalog;
   _catalog = nullptr;
 
@@ -75,23 +131,69 @@ Multidraw::catalog(Catalog* catalog)
   init(catalog);
 }// catalog
 
+void
+Multidraw::beginGesture()
+{
+  if (_gestures++ == 0) {
+    // Nothing logged before the gesture joins it.
+    for (auto& [comp, history] : _histories) {
+      history->seal();
+    }
+  }
+}// beginGesture
+
+void
+Multidraw::endGesture()
+{
+  if (_gestures > 0 && --_gestures == 0) {
+    for (auto& [comp, history] : _histories) {
+      history->seal();
+    }
+  }
+}// endGesture
+
 void
 Multidraw::clearHistory(Component* comp)
 {
   auto iter = _histories.find(comp);
   if (iter != _histories.end()) {
-    iter->second->past.clear();
-    iter->second->future.clear();
+    iter->second->clear();
   }
 }// clearHistory
 
+History*
+Multidraw::history(Component* comp)
+{
+  History*& history = _histories[comp];
+  if (history == nullptr) {
+    history = new History();
+    history->root(comp);
+  }
+  return history;
+}// history
+
 void
 Multidraw::doUpdate()
 {
-  // TODO solve constraints
+  // Only what depends on a Component touched since the last update.
+  _constraints.solve([this](const Constraint& constraint) {
+    for (auto* comp : constraint.outputs()) {
+      update(comp);
+    }
+  });
+
+  if (_headless) {
+    return;
+  }
+
+  if (_frames.all()) {
+    for (auto iter = _editors.cbegin(); iter != _editors.cend(); iter++) {
+      (*iter)->update();
+    }
+  }
 
-  for (auto iter = _editors.cbegin(); iter != _editors.cend(); iter++) {
-    (*iter)->update();
+  for (auto* viewer : _frames.viewers()) {
+    viewer->update();
   }
 }// doUpdate
 
@@ -99,7 +201,31 @@ void
 Multidraw::executeCmd(Command* cmd)
 {
   if (cmd != nullptr) {
+    Multidraw* multidraw = instance();
+    if (multidraw->transacting() && !cmd->reversible()) {
+      // A rollback could not undo it, so it waits for the outermost commit.
+      multidraw->_deferred.emplace_back(multidraw->_transactions.size(), cmd);
+      return;
+    }
+
+    // In a transaction, the outermost commit records it with the rest.
+    if (multidraw->_recorder != nullptr && !multidraw->transacting()) {
+      multidraw->_recorder->record(*cmd);
+    }
+
+    auto start = std::chrono::steady_clock::now();
     cmd->execute();
+    std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+
+    if (multidraw->transacting()) {
+      // Held for the transaction's MacroCmd, and no update until it commits.
+      multidraw->_cost += cost.count();
+      multidraw->_transactions.back()->addChild(std::unique_ptr<Command>(cmd));
+      return;
+    }
+
+    multidraw->_cost = cost.count();
+    multidraw->changed(cmd);
     if (cmd->reversible()) {
       // log() hands the command to Multidraw::log, which adopts ownership.
       cmd->log();
@@ -110,6 +236,132 @@ Multidraw::executeCmd(Command* cmd)
   }
 }// executeCmd
 
+AsyncCmd::Handle
+Multidraw::executeAsync(AsyncCmd* cmd)
+{
+  if (cmd == nullptr) {
+    return AsyncCmd::Handle();
+  }
+  AsyncCmd::Handle handle = cmd->handle();
+
+  // The worker sees the document as it is now, whatever happens to it later.
+  std::shared_ptr<const Snapshot> state = cmd->editor()->component()->root()->snapshot();
+
+  _asyncs.insert(cmd);
+  // Not through _jobs, which is already cleared while the destructor waits for this.
+  JobSystem* jobs = _jobs.get();
+  jobs->spawn([this, jobs, cmd, state] {
+    cmd->run(*state);
+
+    jobs->post([this, cmd] {
+      _asyncs.erase(cmd);
+      if (cmd->status() != AsyncCmd::DONE) {
+        delete cmd;
+        return;
+      }
+
+      // Whatever submitted it issues it again on replay.
+      if (_recorder != nullptr) {
+        _recorder->suspend();
+      }
+      executeCmd(cmd);
+      if (_recorder != nullptr) {
+        _recorder->resume();
+      }
+    });
+  });
+  return handle;
+}// executeAsync
+
+void
+Multidraw::beginTransaction(Editor* editor)
+{
+  if (_transactions.empty()) {
+    _cost = 0.0;
+  }
+  _transactions.push_back(new MacroCmd(editor));
+}// beginTransaction
+
+void
+Multidraw::commit()
+{
+  if (_transactions.empty()) {
+    return;
+  }
+
+  MacroCmd* macro = _transactions.back();
+  _transactions.pop_back();
+
+  // Held commands of a committed transaction now belong to the one around it.
+  for (auto iter = _deferred.rbegin(); iter != _deferred.rend() && iter->first > _transactions.size(); iter++) {
+    iter->first = _transactions.size();
+  }
+
+  if (macro->empty()) {
+    delete macro;
+  } else if (!_transactions.empty()) {
+    _transactions.back()->addChild(std::unique_ptr<Command>(macro));
+  } else {
+    // Only now can none of it be rolled back.
+    if (_recorder != nullptr) {
+      _recorder->record(*macro);
+    }
+    changed(macro);
+    log(macro);
+  }
+
+  if (_transactions.empty()) {
+    // Taken first, as a deferred command may open a transaction of its own.
+    auto deferred = std::move(_deferred);
+    _deferred.clear();
+    for (auto& entry : deferred) {
+      executeCmd(entry.second.release());
+    }
+  }
+}// commit
+
+void
+Multidraw::rollback()
+{
+  if (_transactions.empty()) {
+    return;
+  }
+
+  MacroCmd* macro = _transactions.back();
+  _transactions.pop_back();
+
+  macro->unexecute();
+  while (!_deferred.empty() && _deferred.back().first > _transactions.size()) {
+    _deferred.pop_back();
+  }
+  if (_transactions.empty()) {
+    // Reverted commands may still have touched what is on screen.
+    changed(macro);
+  }
+  delete macro;
+}// rollback
+
+bool
+Multidraw::transaction(Editor* editor, const std::function<bool()>& body)
+{
+  beginTransaction(editor);
+
+  bool committed;
+  try {
+    committed = body();
+  } catch (...) {
+    rollback();
+    throw;
+  }
+
+  if (committed) {
+    commit();
+  } else {
+    rollback();
+  }
+  return committed;
+}// transaction
+
 void
 Multidraw::init(Catalog* catalog)
 {
@@ -119,7 +371,6 @@ Multidraw::init(Catalog* catalog)
   _histories.clear();
 
   alive(true);
-  updated(false);
 }// init
 
 void
@@ -134,27 +385,168 @@ Multidraw::run()
 {
   alive(true);
 
+  if (_headless) {
+    // Nothing can arrive from a display, so run until there is no work left.
+    while (alive()) {
+      _jobs->complete();
+      StateVar::flush();
+
+      if (_frames.pending() && !transacting()) {
+        frame();
+      } else if (!_idle.empty()) {
+        background();
+      } else if (_asyncs.empty()) {
+        break;
+      } else {
+        _jobs->await();
+      }
+    }
+    return;
+  }
+
+  // Lets workers wake the loop with Fl::awake.
+  Fl::lock();
+
   while (alive()) {
-    updated(false);
+    _jobs->complete();
+    // Whatever the last events and results changed, one notice per observer.
+    StateVar::flush();
+
+    // A transaction's intermediate states are never shown.
+    if (_frames.due() && !transacting()) {
+      frame();
+    }
 
-    if (updated()) {
-      update(true);
+    // Events come first; idle tasks only fill the time before them.
+    if (!_idle.empty() && Fl::ready() == 0) {
+      background();
     }
 
-    Fl::wait(FOREVER);
+    // A frame a transaction holds back is no reason to wake before the next event.
+    double timeout = transacting() ? FOREVER : _frames.timeout();
+    Fl::wait(_idle.empty() ? timeout : 0.0);
   }
 }// run
 
+void
+Multidraw::background()
+{
+  // Never into the time of a frame that is about to be due, unless a
+  // transaction holds that frame back anyway.
+  std::chrono::duration<double> seconds(_idle.budget());
+  if (_frames.pending() && !transacting()) {
+    seconds = std::min(seconds, std::chrono::duration<double>(_frames.timeout()));
+  }
+
+  // Headless, nothing else can happen meanwhile, so every pass must advance.
+  _idle.run(IdleScheduler::Clock::now() + std::chrono::duration_cast<IdleScheduler::Clock::duration>(seconds),
+            _headless ? 1 : 0);
+}// background
+
+void
+Multidraw::frame()
+{
+  // Coalesced input first, so the frame shows where it leaves things.
+  for (auto* viewer : _frames.release()) {
+    viewer->flush();
+  }
+
+  _frames.begin();
+  doUpdate();
+  if (!_headless) {
+    // Draw now so the frame's cost is measured against its budget.
+    Fl::flush();
+  }
+  _frames.end();
+}// frame
+
+void
+Multidraw::undo(Component* comp, int steps)
+{
+  if (_recorder != nullptr && steps > 0) {
+    // Replay hands it the Editor it replays into.
+    _recorder->record(UndoCmd(nullptr, steps));
+  }
+
+  auto iter = _histories.find(comp->root());
+
+  // Every step is applied before one update repaints the result.
+  if (iter != _histories.end() && steps > 0 && iter->second->undo(steps) > 0) {
+    modified(iter->first);
+    update(iter->first);
+  }
+}// undo
+
+void
+Multidraw::redo(Component* comp, int steps)
+{
+  if (_recorder != nullptr && steps > 0) {
+    // Replay hands it the Editor it replays into.
+    _recorder->record(RedoCmd(nullptr, steps));
+  }
+
+  auto iter = _histories.find(comp->root());
+
+  if (iter != _histories.end() && steps > 0 && iter->second->redo(steps) > 0) {
+    modified(iter->first);
+    update(iter->first);
+  }
+}// redo
+
+void
+Multidraw::modified(Component* root)
+{
+  for (auto* editor : _editors) {
+    if (editor->component() != nullptr && editor->component()->root() == root) {
+      editor->modified(true);
+    }
+  }
+}// modified
+
 void
 Multidraw::update(bool immediate)
 {
+  _frames.invalidate();
+
   if (immediate) {
-    doUpdate();
+    frame();
+  }
+}// update
+
+void
+Multidraw::update(Component* comp, bool immediate)
+{
+  // Constraints and state are brought up to date even if no Viewer is.
+  _frames.request();
+
+  for (auto* editor : _editors) {
+    Component* shown = editor->component();
+    if (shown != nullptr && (contains(shown, comp) || contains(comp, shown))) {
+      editor->update();
+    }
   }
 
-  updated(!immediate);
+  if (immediate) {
+    frame();
+  }
 }// update
 
+void
+Multidraw::changed(Command* cmd)
+{
+  auto clipboard = cmd->clipboard();
+  if (!clipboard.empty()) {
+    for (auto* comp : clipboard) {
+      update(comp);
+    }
+  } else if (cmd->editor() != nullptr && cmd->editor()->component() != nullptr) {
+    // Acted on nothing in particular, so on anything in its document.
+    update(cmd->editor()->component()->root());
+  } else {
+    update();
+  }
+}// changed
+
 void
 Multidraw::quit()
 {
@@ -166,16 +558,24 @@ Multidraw::log(Command* cmd)
 {
   if (cmd->reversible()) {
     Component* comp = cmd->editor()->component()->root();
+    History* history = instance()->history(comp);
 
-    History*& history = instance()->_histories[comp];
-    if (history == nullptr) {
-      history = new History();
-    }
+    double window = instance()->_gestures > 0 ?
+      std::numeric_limits<double>::infinity() : instance()->_merge_window;
+
+    // What executeCmd measured, which lets History space its checkpoints.
+    double cost = instance()->_cost;
+    instance()->_cost = 0.0;
 
-    // Adopt ownership of the command and record it as the most recent action.
-    // A newly logged command invalidates any pending redo history.
-    history->past.push_back(std::unique_ptr<Command>(cmd));
-    history->future.clear();
+    instance()->modified(comp);
+
+    if (history->merge(*cmd, window, cost)) {
+      delete cmd;
+    } else {
+      // Adopt ownership of the command and record it as the most recent action.
+      // A newly logged command invalidates any pending redo history.
+      history->push(std::unique_ptr<Command>(cmd), cost);
+    }
   } else {
     delete cmd;
   }
@@ -23,15 +23,27 @@
 #ifndef LIBMULTIDRAW_MULTIDRAW_HPP
 #define LIBMULTIDRAW_MULTIDRAW_HPP
 
+#include <functional>
 #include <map>
+#include <memory>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include <libmultidraw/ConstraintNetwork.hpp>
+#include <libmultidraw/FrameScheduler.hpp>
+#include <libmultidraw/IdleScheduler.hpp>
+#include <libmultidraw/JobSystem.hpp>
+#include <libmultidraw/commands/AsyncCmd.hpp>
+
 namespace multidraw {
   class Catalog;
   class Command;
   class Component;
   class Editor;
   class History;
+  class MacroCmd;
+  class Recorder;
 
   /**
    * @brief The Multidraw class provides top-level Application support.
@@ -45,9 +57,15 @@ namespace multidraw {
 
     ~Multidraw();
 
-    /// Starts the event loop
+    /// Starts the event loop. When headless, performs pending updates and returns.
     void run();
+    /// Request an update of every Editor at the next frame, or perform it now.
     void update(bool immediate = false);
+    /**
+     * Request an update of only the Editors that show a Component, part
+     * of it, or something containing it.
+     */
+    void update(Component*, bool immediate = false);
     void quit();
 
     void open(Editor*);
@@ -55,16 +73,75 @@ namespace multidraw {
     void closeAll();
   
     static void log(Command*);
+
+    /**
+     * Commands logged between beginGesture() and endGesture(), such as
+     * the steps of one drag, are merged into a single History entry.
+     * Gestures nest.
+     */
+    void beginGesture();
+    void endGesture();
+    /// Outside a gesture, seconds within which consecutive commands merge.
+    double mergeWindow() const { return _merge_window; }
+    void mergeWindow(double seconds) { _merge_window = seconds; }
+
     void undo(Component*, int);
     void redo(Component*, int);
     void clearHistory(Component*);
+    /// The History of the document rooted at a Component.
+    History* history(Component*);
 
     static void executeCmd(Command*);
+    /**
+     * Compute an AsyncCmd on a worker, then execute and log it from the
+     * event loop. Cancelled or failed commands are deleted unexecuted.
+     * The command belongs to Multidraw from here on; follow it through
+     * the Handle returned.
+     */
+    AsyncCmd::Handle executeAsync(AsyncCmd*);
+    /// AsyncCmds submitted and not yet back on the main thread.
+    size_t asyncs() const { return _asyncs.size(); }
+
+    /// The threads every parallel feature of the library shares.
+    JobSystem& jobs() { return *_jobs; }
+
+    /**
+     * Group the commands executed until commit() into one MacroCmd in
+     * the Editor's History. Updates wait for the outermost commit.
+     * Transactions nest. A command that is not reversible is held and
+     * executed after the outermost commit, since a rollback could not
+     * undo it; a rollback of the transaction it came in drops it.
+     */
+    void beginTransaction(Editor*);
+    void commit();
+    /// Revert the commands of the innermost transaction and discard them.
+    void rollback();
+    bool transacting() const { return !_transactions.empty(); }
+    /**
+     * Run body in a transaction. Commits if it returns true, rolls back
+     * if it returns false or throws. Returns what body returned.
+     */
+    bool transaction(Editor*, const std::function<bool()>& body);
 
     bool alive() const { return _alive; }
-    bool updated() const { return _updated; }
+    /// An update is pending for the next frame.
+    bool updated() const { return _frames.pending(); }
     void alive(bool val) { _alive = val; }
-    void updated(bool val) { _updated = val; }
+
+    /// No display: windows are never shown and FLTK is never called.
+    bool headless() const { return _headless; }
+    /// Set before opening any Editor.
+    void headless(bool val) { _headless = val; }
+
+    FrameScheduler& frames() { return _frames; };
+    /// Solved at the start of every update, before anything is redrawn.
+    ConstraintNetwork& constraints() { return _constraints; };
+    /// Background tasks run while no events are pending.
+    IdleScheduler& idle() { return _idle; };
+
+    /// Receives every command executed and every event handled. Not owned.
+    Recorder* recorder() const { return _recorder; };
+    void recorder(Recorder* recorder) { _recorder = recorder; };
   
     Catalog* catalog() const { return _catalog; };
 
@@ -81,10 +158,31 @@ namespace multidraw {
     Catalog* _catalog;
     std::vector<Editor*> _editors;
     bool _alive;
-    bool _updated;
+    bool _headless;
+    int _gestures;
+    double _merge_window;
+    /// Seconds the command being logged took to execute.
+    double _cost;
+    FrameScheduler _frames;
+    ConstraintNetwork _constraints;
+    IdleScheduler _idle;
     std::map<Component*, History*> _histories;
+    std::vector<MacroCmd*> _transactions;
+    /// Irreversible commands held for the outermost commit, with the depth they came in at.
+    std::vector<std::pair<size_t, std::unique_ptr<Command>>> _deferred;
+    Recorder* _recorder;
+
+    std::set<AsyncCmd*> _asyncs;
+    /// Last, so its workers stop before anything they hand results to goes.
+    std::unique_ptr<JobSystem> _jobs;
 
     void doUpdate();
+    /// Mark every Editor of the document with this root as modified.
+    void modified(Component* root);
+    /// Update the Editors showing what a command acted on.
+    void changed(Command*);
+    void frame();
+    void background();
 
     void init(Catalog*);
   
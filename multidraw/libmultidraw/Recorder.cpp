@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/Recorder.hpp> // class implemented
+
+#include <libmultidraw/commands/InputCmd.hpp>
+
+using namespace multidraw;
+
+Recorder::Recorder(std::ostream& out) :
+  _archive(out),
+  _suspended(0),
+  _commands(0),
+  _inputs(0),
+  _dropped(0)
+{
+}// constructor
+
+void
+Recorder::record(const Command& cmd)
+{
+  if (_suspended > 0) {
+    return;
+  }
+
+  // A Creator could not make one back.
+  if (cmd.classid() == COMMAND) {
+    _dropped++;
+    return;
+  }
+
+  _archive.write(cmd);
+  _commands++;
+}// record
+
+void
+Recorder::record(Editor* editor, int viewer, const Input& input)
+{
+  InputCmd cmd(editor, viewer, input);
+  _archive.write(cmd);
+  _inputs++;
+}// record
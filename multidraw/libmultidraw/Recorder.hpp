@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_RECORDER_HPP
+#define LIBMULTIDRAW_RECORDER_HPP
+
+#include <cstddef>
+#include <iosfwd>
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Input.hpp>
+
+namespace multidraw {
+
+  class Command;
+  class Editor;
+
+  /**
+   * @brief Captures a session: the commands executed and the input events handled.
+   *
+   * Set on Multidraw, a Recorder writes every command as it is executed,
+   * and every event a Viewer handles as an InputCmd, to an Archive that
+   * Replay runs again. A transaction is written as one MacroCmd when the
+   * outermost commit makes it final, and not at all when rolled back;
+   * undo and redo as an UndoCmd and a RedoCmd. Commands issued while an
+   * event is being handled are left out, since handling the event again
+   * issues them again; so are those completed by AsyncCmds.
+   */
+  class Recorder {
+  public:
+    explicit Recorder(std::ostream&);
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /// Record a command about to be executed.
+    void record(const Command&);
+    /// Record an event about to be handled by one of an Editor's Viewers.
+    void record(Editor*, int viewer, const Input&);
+
+    /// Stop recording commands until the matching resume(). Nests.
+    void suspend() { _suspended++; };
+    void resume() { _suspended--; };
+
+    /// Commands written.
+    size_t commands() const { return _commands; };
+    /// Events written.
+    size_t inputs() const { return _inputs; };
+    /// Commands not written because their class has no ClassId of its own.
+    size_t dropped() const { return _dropped; };
+
+    bool good() const { return _archive.good(); };
+
+  private:
+    Archive _archive;
+    int _suspended;
+    size_t _commands;
+    size_t _inputs;
+    size_t _dropped;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_RECORDER_HPP
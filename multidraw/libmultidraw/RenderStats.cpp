@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/RenderStats.hpp> // class implemented
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace multidraw;
+
+const double MILLISECONDS = 1E3;
+const size_t SUMMARY = 256;
+
+RenderStats::RenderStats(size_t window) :
+  _capacity(std::max(window, (size_t)1)),
+  _next(0),
+  _frames(0)
+{
+  _window.reserve(_capacity);
+  _sorted.reserve(_capacity);
+}// constructor
+
+void
+RenderStats::add(const Frame& frame)
+{
+  if (_window.size() < _capacity) {
+    _window.push_back(frame);
+  } else {
+    _window[_next] = frame;
+    _next = (_next + 1) % _capacity;
+  }
+  _frames++;
+}// add
+
+void
+RenderStats::clear()
+{
+  _window.clear();
+  _next = 0;
+  _frames = 0;
+}// clear
+
+const RenderStats::Frame&
+RenderStats::last() const
+{
+  static const Frame none = {};
+  if (_window.empty()) {
+    return none;
+  }
+  return _window[(_next + _window.size() - 1) % _window.size()];
+}// last
+
+double
+RenderStats::percentile(double q, double Frame::* field) const
+{
+  if (_window.empty()) {
+    return 0.0;
+  }
+
+  _sorted.clear();
+  for (const auto& frame : _window) {
+    _sorted.push_back(frame.*field);
+  }
+
+  // The smallest value with at least a fraction q of the window at or below it.
+  auto rank = (size_t)std::ceil(std::clamp(q, 0.0, 1.0) * _sorted.size());
+  auto nth = _sorted.begin() + (std::max(rank, (size_t)1) - 1);
+  std::nth_element(_sorted.begin(), nth, _sorted.end());
+  return *nth;
+}// percentile
+
+std::string
+RenderStats::summary() const
+{
+  const Frame& frame = last();
+  char line[SUMMARY];
+  std::snprintf(line, sizeof(line),
+                "frame %.2f ms (p50 %.2f p95 %.2f p99 %.2f) traversal %.2f ms "
+                "%zu tris %zu draws %zu drawn (%zu coarse) %zu culled %zu uploads",
+                frame.seconds * MILLISECONDS,
+                percentile(0.50) * MILLISECONDS,
+                percentile(0.95) * MILLISECONDS,
+                percentile(0.99) * MILLISECONDS,
+                frame.traversal * MILLISECONDS,
+                frame.triangles, frame.draws, frame.drawn, frame.coarse, frame.culled, frame.uploads);
+  return line;
+}// summary
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_RENDER_STATS_HPP
+#define LIBMULTIDRAW_RENDER_STATS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace multidraw {
+
+  /**
+   * @brief What a Viewer's recent frames cost.
+   *
+   * Keeps the last WINDOW frames, so percentiles follow the current
+   * interaction rather than the whole session. summary() puts the usual
+   * numbers on one line, to paste into a bug report.
+   */
+  class RenderStats {
+  public:
+    static const size_t WINDOW = 240;
+
+    struct Frame {
+      /// CPU time of the whole draw, in seconds.
+      double seconds;
+      /// Of which taking the snapshot and walking it, in seconds.
+      double traversal;
+      size_t triangles;
+      size_t draws;
+      /// Components drawn, and how many of them coarsely.
+      size_t drawn;
+      size_t coarse;
+      /// Components skipped, being hidden or without geometry.
+      size_t culled;
+      /// Buffer uploads and the bytes they sent.
+      size_t uploads;
+      size_t uploaded;
+    };
+
+    RenderStats(size_t window = WINDOW);
+
+    void add(const Frame&);
+    void clear();
+
+    /// Frames added since construction or clear().
+    size_t frames() const { return _frames; };
+    /// Frames in the window.
+    size_t size() const { return _window.size(); };
+    /// The latest frame, zeroed if there is none.
+    const Frame& last() const;
+
+    /// The frame time, in seconds, that a fraction q of the window did not exceed.
+    double percentile(double q) const { return percentile(q, &Frame::seconds); };
+    /// Likewise for the traversal time.
+    double traversal(double q) const { return percentile(q, &Frame::traversal); };
+
+    /// The latest frame and the window's percentiles, on one line.
+    std::string summary() const;
+
+  private:
+    double percentile(double q, double Frame::* field) const;
+
+    std::vector<Frame> _window;
+    size_t _capacity;
+    /// Where the next frame goes once the window is full.
+    size_t _next;
+    size_t _frames;
+    mutable std::vector<double> _sorted;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_RENDER_STATS_HPP
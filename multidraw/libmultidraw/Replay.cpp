@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/Replay.hpp> // class implemented
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/commands/Command.hpp>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+
+using namespace multidraw;
+
+using Clock = std::chrono::steady_clock;
+
+const size_t KILOBYTE = 1024;
+const double MICROSECONDS = 1E6;
+
+static size_t
+peak_memory()
+{
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // Linux reports kilobytes.
+  return (size_t)usage.ru_maxrss * KILOBYTE;
+}// peak_memory
+
+Replay::Replay(Creator& creator, Editor* editor) :
+  _creator(creator),
+  _editor(editor),
+  _stats()
+{
+}// constructor
+
+bool
+Replay::run(std::istream& in)
+{
+  Multidraw* multidraw = Multidraw::instance();
+  Archive archive(in, _creator, _editor);
+
+  auto begin = Clock::now();
+  while (Command* cmd = archive.read_command()) {
+    ClassId id = cmd->classid();
+
+    auto start = Clock::now();
+    Multidraw::executeCmd(cmd);
+    multidraw->run();
+    std::chrono::duration<double> latency = Clock::now() - start;
+
+    _stats.latency[id].add(latency.count());
+    _stats.commands++;
+  }
+  std::chrono::duration<double> seconds = Clock::now() - begin;
+
+  _stats.seconds += seconds.count();
+  _stats.skipped += archive.skipped();
+  _stats.peak = peak_memory();
+  return archive.good();
+}// run
+
+void
+Replay::report(std::ostream& out) const
+{
+  char line[128];
+
+  std::snprintf(line, sizeof(line), "%8s %10s %10s %10s %10s %10s\n",
+                "class", "count", "p50 us", "p95 us", "p99 us", "max us");
+  out << line;
+  for (const auto& [id, latency] : _stats.latency) {
+    std::snprintf(line, sizeof(line), "%8u %10zu %10.1f %10.1f %10.1f %10.1f\n",
+                  (unsigned)id, latency.count(),
+                  latency.percentile(0.50) * MICROSECONDS,
+                  latency.percentile(0.95) * MICROSECONDS,
+                  latency.percentile(0.99) * MICROSECONDS,
+                  latency.max() * MICROSECONDS);
+    out << line;
+  }
+
+  std::snprintf(line, sizeof(line), "%zu commands in %.3f s, %.0f per second, %zu skipped, peak memory %zu MiB\n",
+                _stats.commands, _stats.seconds, _stats.throughput(), _stats.skipped,
+                _stats.peak / (KILOBYTE * KILOBYTE));
+  out << line;
+}// report
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_REPLAY_HPP
+#define LIBMULTIDRAW_REPLAY_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+
+#include <libmultidraw/ClassId.hpp>
+#include <libmultidraw/Histogram.hpp>
+
+namespace multidraw {
+
+  class Creator;
+  class Editor;
+
+  /**
+   * @brief Runs a session captured by a Recorder against an Editor's document.
+   *
+   * Each command is executed as Multidraw::executeCmd would, and the
+   * updates it causes are run before the next, so its latency covers
+   * execution, logging to History and the frame. Meant for a headless
+   * Multidraw with no Recorder set.
+   */
+  class Replay {
+  public:
+    struct Stats {
+      /// Commands executed, events included.
+      size_t commands;
+      /// Records whose class the Creator does not define.
+      size_t skipped;
+      /// Wall time of the whole run.
+      double seconds;
+      /// Peak resident memory of the process, in bytes.
+      size_t peak;
+      /// Latency of each class of command.
+      std::map<ClassId, Histogram> latency;
+
+      /// Commands per second.
+      double throughput() const { return seconds > 0.0 ? commands / seconds : 0.0; };
+    };
+
+    Replay(Creator&, Editor*);
+
+    /// Run every command in the stream. False if the session is malformed.
+    bool run(std::istream&);
+
+    const Stats& stats() const { return _stats; };
+
+    /// A table of the stats, one row per class of command.
+    void report(std::ostream&) const;
+
+  private:
+    Creator& _creator;
+    Editor* _editor;
+    Stats _stats;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_REPLAY_HPP
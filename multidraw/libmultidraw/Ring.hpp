@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_RING_HPP
+#define LIBMULTIDRAW_RING_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace multidraw {
+
+  /**
+   * @brief A double-ended queue in one reusable block.
+   *
+   * Slots are kept when elements are removed, so once a Ring has grown
+   * to its working size, pushing and popping allocate nothing. It grows
+   * by doubling.
+   */
+  template <typename T>
+  class Ring {
+  public:
+    Ring() : _head(0), _size(0) {};
+
+    size_t size() const { return _size; };
+    bool empty() const { return _size == 0; };
+    size_t capacity() const { return _slots.size(); };
+
+    T& operator[](size_t index) { return _slots[(_head + index) & (_slots.size() - 1)]; };
+    const T& operator[](size_t index) const { return _slots[(_head + index) & (_slots.size() - 1)]; };
+
+    T& front() { return (*this)[0]; };
+    T& back() { return (*this)[_size - 1]; };
+    const T& front() const { return (*this)[0]; };
+    const T& back() const { return (*this)[_size - 1]; };
+
+    void push_back(T&& value)
+    {
+      if (_size == _slots.size()) {
+        grow();
+      }
+      _size++;
+      back() = std::move(value);
+    };
+
+    void pop_back()
+    {
+      back() = T();
+      _size--;
+    };
+
+    void pop_front()
+    {
+      front() = T();
+      _head = (_head + 1) & (_slots.size() - 1);
+      _size--;
+    };
+
+    void clear()
+    {
+      while (!empty()) {
+        pop_back();
+      }
+      _head = 0;
+    };
+
+  private:
+    void grow()
+    {
+      // A power of two, so indices wrap with a mask.
+      std::vector<T> slots(_slots.empty() ? 16 : 2 * _slots.size());
+      for (size_t i = 0; i < _size; i++) {
+        slots[i] = std::move((*this)[i]);
+      }
+      _slots.swap(slots);
+      _head = 0;
+    };
+
+    std::vector<T> _slots;
+    size_t _head;
+    size_t _size;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_RING_HPP
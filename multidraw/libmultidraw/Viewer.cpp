@@ -23,53 +23,153 @@
 #include <libmultidraw/Viewer.hpp> // class implemented
 
 #include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/Recorder.hpp>
 #include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
 
 #include <FL/Fl.H>
 #include <FL/gl.h>
 
+#include <chrono>
+#include <cmath>
+
 using namespace multidraw;
 
 const float EPSILON = 1E-06;
-const float ZOOM = 4.0F;
-const float PANX = 0.0F;
-const float PANY = 0.0F;
 const float SCALE = 1.0F;
 const float GREY = 0.5F;
-const int CLIPZ = 100;
+const int CLIPZ = Camera::CLIPZ;
+const int FONT_SIZE = 12;
+const int MARGIN = 4;
+/// Seconds after the last wheel event that zooming counts as over.
+const double WHEEL_IDLE = 0.25;
 
 Viewer::Viewer(int posx, int posy, int width, int height, Editor* editor) :
   Fl_Gl_Window(posx, posy, width, height),
   _editor(editor),
-  _zoom(ZOOM),
-  _pan_x(PANX),
-  _pan_y(PANY),
   _mouse_x(0),
-  _mouse_y(0)
+  _mouse_y(0),
+  _renderer(editor != nullptr ? editor->buffers() : nullptr),
+  _held(),
+  _holding(false),
+  _coalesced(0),
+  _stats(),
+  _overlay(false),
+  _progressive(true),
+  _pressed(false),
+  _wheeled()
 {
   mode(FL_DOUBLE | FL_RGB | FL_DEPTH);  
 }// constructor
 
+Viewer::~Viewer()
+{
+  Multidraw::instance()->frames().forget(this);
+
+  if (context() != nullptr) {
+    make_current();
+    _renderer.release();
+  }
+}// destructor
+
 void
 Viewer::draw()
 {
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+
+  if (context_valid() == '\0') {
+    // A new context holds none of the buffers uploaded to the old one.
+    _renderer.reset();
+  }
+
   if (valid() == '\0') {
     viewport(pixel_w(), pixel_h());
     glClearColor(GREY, GREY, GREY, 1.0F);
   }
 
-  glClear(GL_COLOR_BUFFER_BIT);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   glMatrixMode(GL_MODELVIEW);
   glLoadIdentity();
   glScalef(zoom(), zoom(), 1.0F);
   glTranslatef(pan_x(), pan_y(), 0.0F);
+  glRotatef(_camera.pitch(), 1.0F, 0.0F, 0.0F);
+  glRotatef(_camera.yaw(), 0.0F, 1.0F, 0.0F);
+
+  RenderStats::Frame frame = {};
+  Component* comp = _editor != nullptr ? _editor->component() : nullptr;
+  if (comp != nullptr) {
+    auto snapshot = comp->snapshot();
+    frame.traversal = std::chrono::duration<double>(Clock::now() - start).count();
+    _renderer.progressive(_progressive);
+    _renderer.interactive(interacting());
+    _renderer.render(*snapshot);
+
+    // Refine over the frames to come, or see when the wheel stops.
+    if (_renderer.refining() || (_progressive && wheeling())) {
+      Multidraw::instance()->frames().again(this);
+    }
+
+    const RetainedRenderer::Stats& rendered = _renderer.stats();
+    frame.traversal += rendered.traversal;
+    frame.triangles = rendered.triangles;
+    frame.draws = rendered.draws;
+    frame.drawn = rendered.instances;
+    frame.coarse = rendered.coarse;
+    frame.culled = rendered.culled;
+    frame.uploads = rendered.uploads;
+    frame.uploaded = rendered.uploaded;
+  }
+
+  if (_overlay) {
+    annotate();
+  }
+
+  frame.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  _stats.add(frame);
 }// draw
 
+void
+Viewer::overlay(bool overlay)
+{
+  if (overlay != _overlay) {
+    _overlay = overlay;
+    redraw();
+  }
+}// overlay
+
+void
+Viewer::annotate()
+{
+  // The summary of the frames before this one, at the top-left corner.
+  std::string summary = _stats.summary();
+
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  glColor3f(1.0F, 1.0F, 1.0F);
+  gl_font(FL_COURIER, FONT_SIZE);
+  gl_draw(summary.c_str(), (float)(MARGIN - pixel_w() / 2), (float)(pixel_h() / 2 - MARGIN - FONT_SIZE));
+}// annotate
+
+bool
+Viewer::interacting() const
+{
+  return _pressed || wheeling();
+}// interacting
+
+bool
+Viewer::wheeling() const
+{
+  std::chrono::duration<double> since = std::chrono::steady_clock::now() - _wheeled;
+  return since.count() < WHEEL_IDLE;
+}// wheeling
+
 int
 Viewer::keys(int key)
 {
-  return _editor->keystroke(key);
+  return _editor != nullptr ? _editor->keystroke(key) : 0;
 }// keys
 
 int
@@ -105,24 +205,120 @@ Viewer::handle(int event)
 {
   switch (event) {
   case FL_MOUSEWHEEL:
-    zoom(1 + Fl::event_dy() / SCALE);
-    return 1;
   case FL_KEYUP:
   case FL_KEYDOWN:
-    return keys(Fl::event_key());    
   case FL_PUSH:
-  case FL_DRAG:
   case FL_RELEASE:
-    return mouse(event, Fl::event_x(), Fl::event_y());
+  case FL_DRAG:
+    break;
   default:
     return Fl_Gl_Window::handle(event);
   }
+
+  Input in{event, Fl::event_x(), Fl::event_y(), Fl::event_dy(), Fl::event_key()};
+
+  if (event == FL_DRAG || event == FL_MOUSEWHEEL) {
+    if (_holding && _held.event == event) {
+      // Only the latest position matters, since drags move by the
+      // difference from the last one delivered; wheel movement adds up.
+      in.dy += _held.dy;
+      _coalesced++;
+    } else {
+      flush();
+      Multidraw::instance()->frames().hold(this);
+    }
+    _held = in;
+    _holding = true;
+    return 1;
+  }
+
+  // Whatever came before goes first.
+  flush();
+  return deliver(in);
 }// handle
 
+void
+Viewer::flush()
+{
+  if (_holding) {
+    _holding = false;
+    deliver(_held);
+  }
+}// flush
+
+int
+Viewer::deliver(const Input& in)
+{
+  Recorder* recorder = Multidraw::instance()->recorder();
+  // A replay finds its viewer through the Editor, so without one it is not recorded.
+  if (recorder == nullptr || _editor == nullptr) {
+    return input(in);
+  }
+
+  int index = 0;
+  while ((size_t)index < _editor->viewers() && _editor->viewer(index) != this) {
+    index++;
+  }
+  recorder->record(_editor, index, in);
+
+  // Replaying the event issues these commands again.
+  recorder->suspend();
+  int handled = input(in);
+  recorder->resume();
+  return handled;
+}// deliver
+
+int
+Viewer::input(const Input& in)
+{
+  switch (in.event) {
+  case FL_MOUSEWHEEL:
+    // Exponential, so a burst zooms as far as its events would one by one.
+    _wheeled = std::chrono::steady_clock::now();
+    zoom(std::pow(2.0F, (float)in.dy / SCALE));
+    return 1;
+  case FL_KEYUP:
+  case FL_KEYDOWN:
+    return keys(in.key);
+  case FL_PUSH:
+    {
+      // One press-drag-release is one gesture, so its commands undo as one.
+      // FLTK only sends the release if the press was taken.
+      Multidraw::instance()->beginGesture();
+      int handled = mouse(in.event, in.x, in.y);
+      if (handled == 0) {
+        Multidraw::instance()->endGesture();
+      }
+      _pressed = handled != 0;
+      return handled;
+    }
+  case FL_RELEASE:
+    {
+      int handled = mouse(in.event, in.x, in.y);
+      Multidraw::instance()->endGesture();
+      // Refine what the gesture drew coarsely.
+      if (_pressed && _progressive) {
+        update();
+      }
+      _pressed = false;
+      return handled;
+    }
+  case FL_DRAG:
+    return mouse(in.event, in.x, in.y);
+  default:
+    return 0;
+  }
+}// input
+
 void
 Viewer::update()
 {
-  redraw();
+  FrameScheduler& frames = Multidraw::instance()->frames();
+  if (frames.framing()) {
+    redraw();
+  } else {
+    frames.invalidate(this);
+  }
 }// update
 
 void
@@ -142,27 +338,31 @@ Viewer::viewport(int width, int height)
   glOrtho(-width/2, width/2, -height/2, height/2, -CLIPZ, CLIPZ);  
 }// viewport
 
+void
+Viewer::camera(const Camera& camera)
+{
+  _camera = camera;
+  update();
+}// camera
+
 void
 Viewer::reset()
 {
-  _zoom = ZOOM;
-  _pan_x = PANX;
-  _pan_y = PANY;
-  redraw();
+  _camera.reset();
+  update();
 }// reset
 
 void
 Viewer::pan(float deltax, float deltay)
 {
-  _pan_x += deltax / _zoom;
-  _pan_y += deltay / _zoom;
-  redraw();
+  _camera.pan(deltax, deltay);
+  update();
 }// pan
 
 void
 Viewer::zoom(float factor)
 {
-  _zoom *= factor;
-  redraw();
+  _camera.zoom(factor);
+  update();
 }// zoom
 
@@ -25,6 +25,13 @@
 
 #include <FL/Fl_Gl_Window.H>
 
+#include <chrono>
+
+#include <libmultidraw/Camera.hpp>
+#include <libmultidraw/Input.hpp>
+#include <libmultidraw/RenderStats.hpp>
+#include <libmultidraw/renderers/RetainedRenderer.hpp>
+
 namespace multidraw {
 
   class Editor;
@@ -34,9 +41,22 @@ namespace multidraw {
    */
   class Viewer : public Fl_Gl_Window {
   public:
+    /// Without an Editor, a Viewer draws nothing and ignores keys.
     Viewer(int posx, int posy, int width, int height, Editor*);
+    virtual ~Viewer();
 
+    /**
+     * Takes an FLTK event. Motion and wheel events are coalesced: each
+     * burst reaches input() as one event, just before the next frame.
+     */
     virtual int handle(int event);
+    /// Deliver any input held back for coalescing.
+    void flush();
+    /// Events merged into others since construction.
+    size_t coalesced() const { return _coalesced; };
+
+    /// Handle an event, whether it came from FLTK or from a recording.
+    virtual int input(const Input&);
     
     virtual void draw();
 
@@ -44,12 +64,35 @@ namespace multidraw {
     
     virtual void update();
 
+    const Camera& camera() const { return _camera; };
+    /// Look through another camera, such as one facing the buccal side.
+    void camera(const Camera&);
+
+    /// What the recent frames cost.
+    const RenderStats& stats() const { return _stats; };
+    /// Print the stats summary over the view. Off by default.
+    bool overlay() const { return _overlay; };
+    void overlay(bool overlay);
+
+    /**
+     * Draw large meshes coarsely while the view is being dragged or
+     * wheeled, and refine them over the frames after. On by default.
+     */
+    bool progressive() const { return _progressive; };
+    void progressive(bool progressive) { _progressive = progressive; };
+    /// Triangles refined per frame once input is idle; 0 for no limit.
+    size_t refinement() const { return _renderer.budget(); };
+    void refinement(size_t triangles) { _renderer.budget(triangles); };
+    /// A button is down, or the wheel turned a moment ago.
+    bool interacting() const;
+
   protected:
     Editor* editor() const { return _editor; };
+    RetainedRenderer& renderer() { return _renderer; };
     
-    float zoom() const { return _zoom; };
-    float pan_x() const { return _pan_x; };
-    float pan_y() const { return _pan_y; };
+    float zoom() const { return _camera.zoom(); };
+    float pan_x() const { return _camera.pan_x(); };
+    float pan_y() const { return _camera.pan_y(); };
 
     virtual void reset();
     virtual void pan(float deltax, float deltay);
@@ -61,12 +104,24 @@ namespace multidraw {
     virtual void viewport(int width, int height);
 
   private:    
+    int deliver(const Input&);
+    void annotate();
+    bool wheeling() const;
+
     Editor* _editor;
-    float _zoom;
-    float _pan_x;
-    float _pan_y;
+    Camera _camera;
     int _mouse_x;
     int _mouse_y;
+    RetainedRenderer _renderer;
+    /// The burst of FL_DRAG or FL_MOUSEWHEEL events not yet delivered.
+    Input _held;
+    bool _holding;
+    size_t _coalesced;
+    RenderStats _stats;
+    bool _overlay;
+    bool _progressive;
+    bool _pressed;
+    std::chrono::steady_clock::time_point _wheeled;
   };
 
 }
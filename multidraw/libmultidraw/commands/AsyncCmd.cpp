@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/commands/AsyncCmd.hpp> // class implemented
+
+using namespace multidraw;
+
+AsyncCmd::AsyncCmd(Editor* editor, std::span<Component* const> clipboard) :
+  Command(editor, clipboard),
+  _state(std::make_shared<State>())
+{
+}// constructor
+
+AsyncCmd::AsyncCmd(Editor* editor, std::initializer_list<Component*> clipboard) :
+  Command(editor, clipboard),
+  _state(std::make_shared<State>())
+{
+}// constructor
+
+void
+AsyncCmd::execute()
+{
+  apply();
+  Command::execute();
+}// execute
+
+void
+AsyncCmd::run(const Snapshot& state)
+{
+  if (_state->cancelled) {
+    _state->status = CANCELLED;
+    return;
+  }
+
+  _state->status = RUNNING;
+  bool computed = false;
+  try {
+    computed = compute(state);
+  } catch (...) {
+    // Nothing on a worker could handle it; the command fails instead.
+    computed = false;
+  }
+
+  if (_state->cancelled) {
+    _state->status = CANCELLED;
+  } else if (computed) {
+    _state->progress = 1.0F;
+    _state->status = DONE;
+  } else {
+    _state->status = FAILED;
+  }
+}// run
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_ASYNC_CMD_HPP
+#define LIBMULTIDRAW_ASYNC_CMD_HPP
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <span>
+
+#include <libmultidraw/commands/Command.hpp>
+
+namespace multidraw {
+
+  class Snapshot;
+
+  /**
+   * @brief A Command whose heavy part runs off the main thread.
+   *
+   * Given to Multidraw::executeAsync, compute() runs on a worker against a
+   * Snapshot of the document taken at submission. When it succeeds the
+   * command comes back to the main loop, where execute() calls apply()
+   * and the command is logged as usual. A redo calls execute() again and
+   * does not recompute.
+   *
+   * The document may change while compute() runs; apply() should check
+   * that its result still fits.
+   *
+   * Multidraw owns the command once it is submitted. It may be deleted,
+   * or merged into another and deleted, as soon as it is back on the main
+   * loop, so callers keep the Handle executeAsync returns, never the
+   * command itself.
+   */
+  class AsyncCmd : public Command {
+  public:
+    enum Status { QUEUED, RUNNING, DONE, FAILED, CANCELLED };
+
+  private:
+    struct State {
+      std::atomic<Status> status{QUEUED};
+      std::atomic<float> progress{0.0F};
+      std::atomic<bool> cancelled{false};
+    };
+
+  public:
+    /**
+     * @brief A submitted AsyncCmd's status, progress and cancellation.
+     *
+     * Shares them with the command, and stays valid after it is gone.
+     * Safe from any thread.
+     */
+    class Handle {
+    public:
+      Handle() = default;
+
+      /// QUEUED for a Handle to nothing.
+      Status status() const { return _state != nullptr ? _state->status.load() : QUEUED; };
+      float progress() const { return _state != nullptr ? _state->progress.load() : 0.0F; };
+      /// Ask compute() to stop; too late once it is DONE.
+      void cancel() { if (_state != nullptr) { _state->cancelled = true; } };
+      bool cancelled() const { return _state != nullptr && _state->cancelled; };
+
+      /// compute() has ended, one way or another.
+      bool finished() const { return status() != QUEUED && status() != RUNNING; };
+
+    private:
+      friend class AsyncCmd;
+      explicit Handle(std::shared_ptr<State> state) : _state(std::move(state)) {};
+
+      std::shared_ptr<State> _state;
+    };
+
+    virtual void execute();
+
+    /// Run compute(). Called on a worker by Multidraw.
+    void run(const Snapshot&);
+
+    /// Shares the state of this command with whoever keeps it.
+    Handle handle() const { return Handle(_state); };
+
+    Status status() const { return _state->status; };
+    /// Fraction of compute() done, from 0 to 1. Safe from any thread.
+    float progress() const { return _state->progress; };
+
+    /// Ask compute() to stop. Safe from any thread.
+    void cancel() { _state->cancelled = true; };
+    bool cancelled() const { return _state->cancelled; };
+
+  protected:
+    AsyncCmd(Editor*, std::span<Component* const> = {});
+    AsyncCmd(Editor*, std::initializer_list<Component*>);
+
+    /**
+     * Produce the result from a version of the document, on a worker.
+     * Must not touch live Components. Should call progress() and return
+     * early, with false, once cancelled(). Returns false, or throws, on
+     * failure.
+     */
+    virtual bool compute(const Snapshot&) = 0;
+    /// Make the computed result take effect, on the main thread.
+    virtual void apply() = 0;
+
+    void progress(float fraction) { _state->progress = fraction; };
+
+  private:
+    std::shared_ptr<State> _state;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_ASYNC_CMD_HPP
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/commands/Clipboard.hpp> // class implemented
+
+#include <algorithm>
+
+using namespace multidraw;
+
+Clipboard::Clipboard() :
+  _data(_inline),
+  _size(0)
+{
+}// constructor
+
+Clipboard::Clipboard(std::span<Component* const> comps) :
+  _data(_inline),
+  _size(0)
+{
+  assign(comps.data(), comps.size());
+}// constructor
+
+Clipboard::Clipboard(std::initializer_list<Component*> comps) :
+  _data(_inline),
+  _size(0)
+{
+  assign(comps.begin(), comps.size());
+}// constructor
+
+Clipboard::Clipboard(const Clipboard& other) :
+  _data(_inline),
+  _size(0)
+{
+  assign(other._data, other._size);
+}// copy constructor
+
+Clipboard&
+Clipboard::operator=(const Clipboard& other)
+{
+  if (this != &other) {
+    assign(other._data, other._size);
+  }
+  return *this;
+}// operator=
+
+Clipboard::~Clipboard()
+{
+  if (_data != _inline) {
+    delete[] _data;
+  }
+}// destructor
+
+void
+Clipboard::assign(Component* const* comps, size_t size)
+{
+  if (size > INLINE && size > _size) {
+    if (_data != _inline) {
+      delete[] _data;
+    }
+    _data = new Component*[size];
+  }
+  std::copy(comps, comps + size, _data);
+  _size = size;
+}// assign
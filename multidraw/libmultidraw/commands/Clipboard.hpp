@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_CLIPBOARD_HPP
+#define LIBMULTIDRAW_CLIPBOARD_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+
+namespace multidraw {
+
+  class Component;
+
+  /**
+   * @brief The Components a Command operates on.
+   *
+   * Up to INLINE Components are stored in the Clipboard itself, so a
+   * Command with a short clipboard allocates nothing for it.
+   */
+  class Clipboard {
+  public:
+    static const size_t INLINE = 4;
+
+    Clipboard();
+    Clipboard(std::span<Component* const>);
+    Clipboard(std::initializer_list<Component*>);
+    Clipboard(const Clipboard&);
+    Clipboard& operator=(const Clipboard&);
+    ~Clipboard();
+
+    size_t size() const { return _size; };
+    bool empty() const { return _size == 0; };
+
+    Component* const* begin() const { return _data; };
+    Component* const* end() const { return _data + _size; };
+    Component* operator[](size_t index) const { return _data[index]; };
+
+    operator std::span<Component* const>() const { return {_data, _size}; };
+
+    /// Bytes held outside the Clipboard itself.
+    size_t bytes() const { return _data == _inline ? 0 : _size * sizeof(Component*); };
+
+  private:
+    void assign(Component* const*, size_t);
+
+    Component** _data;
+    size_t _size;
+    Component* _inline[INLINE];
+  };
+
+}
+
+#endif // LIBMULTIDRAW_CLIPBOARD_HPP
@@ -22,12 +22,21 @@
 
 #include <libmultidraw/commands/Command.hpp> // class implemented
 
+#include <libmultidraw/Archive.hpp>
 #include <libmultidraw/Multidraw.hpp>
 #include <libmultidraw/components/Component.hpp>
 
+#include <vector>
+
 using namespace multidraw;
 
-Command::Command(Editor* editor, std::vector<Component*> clipboard) :
+Command::Command(Editor* editor, std::span<Component* const> clipboard) :
+  _editor(editor),
+  _clipboard(clipboard)
+{
+}
+
+Command::Command(Editor* editor, std::initializer_list<Component*> clipboard) :
   _editor(editor),
   _clipboard(clipboard)
 {
@@ -36,9 +45,10 @@ Command::Command(Editor* editor, std::vector<Component*> clipboard) :
 void
 Command::execute()
 {
-  std::vector<Component*>::iterator iter = _clipboard.begin();
+  auto iter = _clipboard.begin();
   while (iter != _clipboard.end()) {
     (*iter)->interpret(this);
+    (*iter)->touch();
     iter++;
   }
 }// execute
@@ -46,9 +56,10 @@ Command::execute()
 void
 Command::unexecute()
 {
-  std::vector<Component*>::iterator iter = _clipboard.begin();
+  auto iter = _clipboard.begin();
   while (iter != _clipboard.end()) {
     (*iter)->uninterpret(this);
+    (*iter)->touch();
     iter++;
   }
 }// unexecute
@@ -64,3 +75,87 @@ Command::log()
 {
   Multidraw::log(this);
 }// log
+
+bool
+Command::merge(const Command&)
+{
+  return false;
+}// merge
+
+size_t
+Command::bytes() const
+{
+  return sizeof(Command) + _clipboard.bytes();
+}// bytes
+
+void
+Command::compress()
+{
+}// compress
+
+void
+Command::decompress()
+{
+}// decompress
+
+bool
+Command::spill(std::ostream&)
+{
+  return false;
+}// spill
+
+bool
+Command::unspill(std::istream&)
+{
+  return false;
+}// unspill
+
+ClassId
+Command::classid() const
+{
+  return COMMAND;
+}// classid
+
+bool
+Command::write(Archive& archive) const
+{
+  archive.write_varint(_clipboard.size());
+  for (Component* comp : _clipboard) {
+    archive.write_path(comp);
+  }
+  return true;
+}// write
+
+bool
+Command::read(Archive& archive)
+{
+  // Every path takes at least a byte, which bounds a corrupt count.
+  size_t size = archive.read_varint();
+  if (size > archive.remaining()) {
+    return false;
+  }
+
+  // A path that no longer leads anywhere fails the read, since
+  // execute() would interpret a null Component.
+  bool found = true;
+  if (size <= Clipboard::INLINE) {
+    Component* comps[Clipboard::INLINE];
+    for (size_t i = 0; i < size; i++) {
+      comps[i] = archive.read_path();
+      found = found && comps[i] != nullptr;
+    }
+    if (found) {
+      clipboard({comps, size});
+    }
+  } else {
+    std::vector<Component*> comps(size);
+    for (auto& comp : comps) {
+      comp = archive.read_path();
+      found = found && comp != nullptr;
+    }
+    if (found) {
+      clipboard(comps);
+    }
+  }
+  return found && archive.good();
+}// read
@@ -23,10 +23,17 @@
 #ifndef LIBMULTIDRAW_COMMAND_HPP
 #define LIBMULTIDRAW_COMMAND_HPP
 
-#include <vector>
+#include <cstddef>
+#include <initializer_list>
+#include <iosfwd>
+#include <span>
+
+#include <libmultidraw/ClassId.hpp>
+#include <libmultidraw/commands/Clipboard.hpp>
 
 namespace multidraw {
 
+  class Archive;
   class Editor;
   class Component;
 
@@ -45,17 +52,50 @@ namespace multidraw {
 
     virtual void log();
 
+    /**
+     * Absorb a command of the same type, on the same Editor and clipboard,
+     * that was executed right after this one, so that unexecute() reverts
+     * both. Returns false if the two cannot be combined.
+     */
+    virtual bool merge(const Command&);
+
+    /// Bytes retained while this command sits in a History.
+    virtual size_t bytes() const;
+
+    /// Shrink the retained state of a command that is unlikely to be undone soon.
+    virtual void compress();
+    /// Undo compress(). Called before the command is executed again.
+    virtual void decompress();
+
+    /**
+     * Write the retained state to a stream and release it. Returns false,
+     * without writing, if the command cannot be spilled.
+     */
+    virtual bool spill(std::ostream&);
+    /// Read back the state written by spill().
+    virtual bool unspill(std::istream&);
+
+    /// The id an Archive records, and a Creator makes, this class by.
+    virtual ClassId classid() const;
+    /// Write what read() needs to rebuild this command. Sub-classes write their base first.
+    virtual bool write(Archive&) const;
+    /// Fill in a command made by a Creator from what write() wrote.
+    virtual bool read(Archive&);
+
     Editor* editor() const { return _editor; };
     void editor(Editor* ed) { _editor = ed; };
 
-    std::vector<Component*> clipboard() const { return _clipboard; };
+    std::span<Component* const> clipboard() const { return _clipboard; };
 
   protected:
-    Command(Editor*, std::vector<Component*> = std::vector<Component*>());
+    Command(Editor*, std::span<Component* const> = {});
+    Command(Editor*, std::initializer_list<Component*>);
+
+    void clipboard(std::span<Component* const> comps) { _clipboard = Clipboard(comps); };
 
   private:
     Editor* _editor;
-    std::vector<Component*> _clipboard;
+    Clipboard _clipboard;
 
   };
 
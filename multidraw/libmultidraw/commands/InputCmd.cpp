@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/commands/InputCmd.hpp> // class implemented
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Viewer.hpp>
+
+using namespace multidraw;
+
+/// Signed values as varints, small in either direction.
+static uint64_t
+zigzag(int value)
+{
+  return ((uint64_t)(int64_t)value << 1) ^ (uint64_t)((int64_t)value >> 63);
+}// zigzag
+
+static int
+unzigzag(uint64_t value)
+{
+  return (int)(int64_t)((value >> 1) ^ (~(value & 1) + 1));
+}// unzigzag
+
+InputCmd::InputCmd(Editor* editor, int viewer, const Input& input) :
+  Command(editor),
+  _viewer(viewer),
+  _input(input)
+{
+}// constructor
+
+void
+InputCmd::execute()
+{
+  Viewer* viewer = editor() != nullptr ? editor()->viewer(_viewer) : nullptr;
+  if (viewer != nullptr) {
+    viewer->input(_input);
+  }
+}// execute
+
+bool
+InputCmd::reversible() const
+{
+  return false;
+}// reversible
+
+ClassId
+InputCmd::classid() const
+{
+  return INPUT_CMD;
+}// classid
+
+bool
+InputCmd::write(Archive& archive) const
+{
+  if (!Command::write(archive)) {
+    return false;
+  }
+  archive.write_varint(_viewer);
+  archive.write_varint(zigzag(_input.event));
+  archive.write_varint(zigzag(_input.x));
+  archive.write_varint(zigzag(_input.y));
+  archive.write_varint(zigzag(_input.dy));
+  archive.write_varint(zigzag(_input.key));
+  return true;
+}// write
+
+bool
+InputCmd::read(Archive& archive)
+{
+  if (!Command::read(archive)) {
+    return false;
+  }
+  _viewer = (int)archive.read_varint();
+  _input.event = unzigzag(archive.read_varint());
+  _input.x = unzigzag(archive.read_varint());
+  _input.y = unzigzag(archive.read_varint());
+  _input.dy = unzigzag(archive.read_varint());
+  _input.key = unzigzag(archive.read_varint());
+  return archive.good();
+}// read
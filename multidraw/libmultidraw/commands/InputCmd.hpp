@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_INPUT_CMD_HPP
+#define LIBMULTIDRAW_INPUT_CMD_HPP
+
+#include <libmultidraw/Input.hpp>
+#include <libmultidraw/commands/Command.hpp>
+
+namespace multidraw {
+
+  /**
+   * @brief Hands a recorded event to one of an Editor's Viewers.
+   *
+   * Replaying one goes through the same tools, gestures and commands as
+   * the original event did. It is not itself undoable.
+   */
+  class InputCmd : public Command {
+  public:
+    InputCmd(Editor*, int viewer = 0, const Input& = Input());
+
+    virtual void execute();
+
+    virtual bool reversible() const;
+
+    virtual ClassId classid() const;
+    virtual bool write(Archive&) const;
+    virtual bool read(Archive&);
+
+    int viewer() const { return _viewer; };
+    const Input& input() const { return _input; };
+
+  private:
+    int _viewer;
+    Input _input;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_INPUT_CMD_HPP
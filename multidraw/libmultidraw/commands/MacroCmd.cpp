@@ -22,29 +22,69 @@
 
 #include <libmultidraw/commands/MacroCmd.hpp> // class implemented
 
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Creator.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <istream>
+#include <ostream>
+#include <typeinfo>
+#include <unordered_map>
+
 using namespace multidraw;
 
-MacroCmd::MacroCmd(Editor* editor) : Command(editor)
+static Creator*
+creator()
+{
+  Catalog* catalog = Multidraw::instance()->catalog();
+  return catalog != nullptr ? catalog->creator() : nullptr;
+}// creator
+
+MacroCmd::MacroCmd(Editor* editor) :
+  Command(editor),
+  _parallel(false),
+  _spillable(false),
+  _spilled(0)
 {
 }// constructor
 
 void
 MacroCmd::execute()
 {
-  auto iter = _children.begin();
-  while (iter != _children.end()) {
-    (*iter)->execute();
-    iter++;
+  if (!_parallel || _children.size() < 2) {
+    auto iter = _children.begin();
+    while (iter != _children.end()) {
+      (*iter)->execute();
+      iter++;
+    }
+    return;
+  }
+
+  for (const auto& wave : schedule()) {
+    run(wave, true);
   }
 }// execute
 
 void
 MacroCmd::unexecute()
 {
-  auto iter = _children.begin();
-  while (iter != _children.end()) {
-    (*iter)->unexecute();
-    iter++;
+  if (!_parallel || _children.size() < 2) {
+    // Later children may depend on earlier ones, so revert newest first.
+    auto iter = _children.rbegin();
+    while (iter != _children.rend()) {
+      (*iter)->unexecute();
+      iter++;
+    }
+    return;
+  }
+
+  auto waves = schedule();
+  for (auto wave = waves.crbegin(); wave != waves.crend(); wave++) {
+    run(*wave, false);
   }
 }// unexecute
 
@@ -62,6 +102,153 @@ MacroCmd::reversible() const
   return reversible;
 }// reversible
 
+size_t
+MacroCmd::bytes() const
+{
+  size_t bytes = sizeof(MacroCmd) + _children.capacity() * sizeof(std::unique_ptr<Command>) +
+    _targets.capacity() * sizeof(Component*);
+  for (const auto& child : _children) {
+    bytes += child->bytes();
+  }
+  return bytes;
+}// bytes
+
+void
+MacroCmd::compress()
+{
+  for (auto& child : _children) {
+    child->compress();
+  }
+}// compress
+
+void
+MacroCmd::decompress()
+{
+  for (auto& child : _children) {
+    child->decompress();
+  }
+}// decompress
+
+bool
+MacroCmd::spill(std::ostream& out)
+{
+  if (_spillable) {
+    Creator* maker = creator();
+    if (maker == nullptr || _children.empty() || !packable(*maker)) {
+      return false;
+    }
+
+    Archive archive(out);
+    for (const auto& child : _children) {
+      if (!archive.write(*child)) {
+        return false;
+      }
+    }
+
+    targets(_targets);
+    _spilled = _children.size();
+    _children.clear();
+    _children.shrink_to_fit();
+    return true;
+  }
+
+  // All or nothing: a partly spilled macro could not be restored by offset.
+  std::ostream::pos_type start = out.tellp();
+  auto iter = _children.cbegin();
+  while (iter != _children.cend()) {
+    if (!(*iter)->spill(out)) {
+      // Bring back the children already written.
+      std::istream in(out.rdbuf());
+      in.seekg(start);
+      for (auto done = _children.cbegin(); done != iter; done++) {
+        (*done)->unspill(in);
+      }
+      return false;
+    }
+    iter++;
+  }
+  return true;
+}// spill
+
+bool
+MacroCmd::unspill(std::istream& in)
+{
+  if (_spilled > 0) {
+    Creator* maker = creator();
+    if (maker == nullptr) {
+      return false;
+    }
+
+    Archive archive(in, *maker, editor());
+    for (size_t i = 0; i < _spilled; i++) {
+      std::unique_ptr<Command> child(archive.read_command());
+      if (child == nullptr) {
+        return false;
+      }
+      addChild(std::move(child));
+    }
+
+    // Paths that lead elsewhere now would have the children change other Components.
+    std::vector<Component*> found;
+    targets(found);
+    bool same = found == _targets;
+    _spilled = 0;
+    _targets.clear();
+    _targets.shrink_to_fit();
+    return same;
+  }
+
+  bool ok = true;
+  for (auto& child : _children) {
+    ok = child->unspill(in) && ok;
+  }
+  return ok;
+}// unspill
+
+ClassId
+MacroCmd::classid() const
+{
+  return MACRO_CMD;
+}// classid
+
+bool
+MacroCmd::write(Archive& archive) const
+{
+  if (!Command::write(archive)) {
+    return false;
+  }
+  archive.write_varint(_children.size());
+  for (const auto& child : _children) {
+    if (!archive.write(*child)) {
+      return false;
+    }
+  }
+  archive.write_varint(_parallel ? 1 : 0);
+  return true;
+}// write
+
+bool
+MacroCmd::read(Archive& archive)
+{
+  if (!Command::read(archive)) {
+    return false;
+  }
+
+  size_t size = archive.read_varint();
+  if (size > archive.remaining()) {
+    return false;
+  }
+  _children.reserve(_children.size() + size);
+  for (size_t i = 0; i < size && archive.good(); i++) {
+    // Children of classes this reader does not know are left out.
+    std::unique_ptr<Command> child(archive.read_command());
+    if (child != nullptr) {
+      addChild(std::move(child));
+    }
+  }
+  _parallel = archive.read_varint() != 0;
+  return archive.good();
+}// read
 
 void
 MacroCmd::addChild(std::unique_ptr<Command> cmd)
@@ -69,3 +256,132 @@ MacroCmd::addChild(std::unique_ptr<Command> cmd)
   cmd->editor(this->editor());
   _children.push_back(std::move(cmd));
 }// addChild
+
+bool
+MacroCmd::packable(const Creator& maker) const
+{
+  for (const auto& child : _children) {
+    std::unique_ptr<Command> blank(maker.create(child->classid(), editor()));
+    if (blank == nullptr || typeid(*blank) != typeid(*child)) {
+      return false;
+    }
+    auto* macro = dynamic_cast<const MacroCmd*>(child.get());
+    if (macro != nullptr && !macro->packable(maker)) {
+      return false;
+    }
+  }
+  return true;
+}// packable
+
+void
+MacroCmd::targets(std::vector<Component*>& found) const
+{
+  for (const auto& child : _children) {
+    for (Component* comp : child->clipboard()) {
+      found.push_back(comp);
+    }
+    auto* macro = dynamic_cast<const MacroCmd*>(child.get());
+    if (macro != nullptr) {
+      macro->targets(found);
+    }
+  }
+}// targets
+
+std::vector<std::vector<size_t>>
+MacroCmd::schedule() const
+{
+  std::vector<size_t> wave(_children.size(), 0);
+  // The last child to write each Component, and those that wrote below it since.
+  std::unordered_map<const Component*, size_t> writer;
+  std::unordered_map<const Component*, std::vector<size_t>> below;
+  size_t floor = 0;
+  size_t deepest = 0;
+
+  for (size_t index = 0; index < _children.size(); index++) {
+    auto clipboard = _children[index]->clipboard();
+
+    if (clipboard.empty()) {
+      // A barrier: after everything before it, before everything after.
+      wave[index] = index == 0 ? 0 : deepest + 1;
+      deepest = wave[index];
+      floor = wave[index] + 1;
+      writer.clear();
+      below.clear();
+      continue;
+    }
+
+    size_t first = floor;
+    for (const Component* comp : clipboard) {
+      for (const Component* above = comp->parent(); above != nullptr; above = above->parent()) {
+        auto iter = writer.find(above);
+        if (iter != writer.end()) {
+          first = std::max(first, wave[iter->second] + 1);
+        }
+      }
+      auto iter = below.find(comp);
+      if (iter != below.end()) {
+        for (size_t earlier : iter->second) {
+          first = std::max(first, wave[earlier] + 1);
+        }
+      }
+    }
+    wave[index] = first;
+    deepest = std::max(deepest, first);
+
+    for (const Component* comp : clipboard) {
+      // Later children conflicting with what was below depend on this one now.
+      writer[comp] = index;
+      below[comp] = { index };
+      for (const Component* above = comp->parent(); above != nullptr; above = above->parent()) {
+        below[above].push_back(index);
+      }
+    }
+  }
+
+  std::vector<std::vector<size_t>> waves(_children.empty() ? 0 : deepest + 1);
+  for (size_t index = 0; index < _children.size(); index++) {
+    waves[wave[index]].push_back(index);
+  }
+  return waves;
+}// schedule
+
+void
+MacroCmd::run(const std::vector<size_t>& wave, bool forward)
+{
+  if (wave.size() == 1) {
+    if (forward) {
+      _children[wave[0]]->execute();
+    } else {
+      _children[wave[0]]->unexecute();
+    }
+    return;
+  }
+
+  // Mark the ancestors now, so that the children's own touches only
+  // ever read what they share.
+  for (size_t index : wave) {
+    for (Component* comp : _children[index]->clipboard()) {
+      comp->touch();
+    }
+  }
+
+  // As in order, the first child to throw is the one whose exception escapes.
+  std::vector<std::exception_ptr> errors(wave.size());
+  Multidraw::instance()->jobs().parallel_for(wave.size(), [&](size_t slot) {
+    try {
+      if (forward) {
+        _children[wave[slot]]->execute();
+      } else {
+        _children[wave[slot]]->unexecute();
+      }
+    } catch (...) {
+      errors[slot] = std::current_exception();
+    }
+  });
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}// run
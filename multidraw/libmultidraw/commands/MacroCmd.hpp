@@ -25,6 +25,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <libmultidraw/commands/Command.hpp>
 
@@ -32,9 +33,22 @@ namespace multidraw {
 
   class Editor;
   class Component;
+  class Creator;
 
   /**
    * @brief The COMPOSITE COMMAND pattern.
+   *
+   * In parallel mode, children whose clipboards lie in disjoint subtrees
+   * run at the same time on Multidraw's workers. A child depends on every
+   * earlier child whose clipboard holds one of its Components, or an
+   * ancestor or descendant of one; a child with an empty clipboard
+   * depends on, and is depended on by, all others. The result is the same
+   * as running them in order, provided each child changes only the
+   * subtrees of its clipboard.
+   *
+   * A spillable macro is spilled by writing its children to the History's
+   * file as Archive records and dropping them; they are read back, with
+   * the Catalog's Creator, when it is undone or redone again.
    */
   class MacroCmd : public Command {
   public:
@@ -46,11 +60,47 @@ namespace multidraw {
 
     virtual bool reversible() const;
 
+    virtual size_t bytes() const;
+    virtual void compress();
+    virtual void decompress();
+    virtual bool spill(std::ostream&);
+    virtual bool unspill(std::istream&);
+
+    virtual ClassId classid() const;
+    virtual bool write(Archive&) const;
+    virtual bool read(Archive&);
+
     void addChild(std::unique_ptr<Command>);
+    bool empty() const { return _children.empty(); };
+
+    bool parallel() const { return _parallel; };
+    void parallel(bool parallel) { _parallel = parallel; };
+
+    bool spillable() const { return _spillable; };
+    /**
+     * Set only when every child's write() records all that its
+     * unexecute() needs. Children whose class the Creator does not make
+     * keep the macro in memory.
+     */
+    void spillable(bool spillable) { _spillable = spillable; };
 
   protected:
   private:
+    /// Children in waves; each wave depends only on the ones before it.
+    std::vector<std::vector<size_t>> schedule() const;
+    void run(const std::vector<size_t>& wave, bool forward);
+
+    /// Whether the Creator reads every child, at any depth, back as its own class.
+    bool packable(const Creator&) const;
+    /// The clipboards of every child, at any depth, in order.
+    void targets(std::vector<Component*>&) const;
+
     std::vector<std::unique_ptr<Command>> _children;
+    bool _parallel;
+    bool _spillable;
+    /// Children written out by spill(), and the Components they referred to.
+    size_t _spilled;
+    std::vector<Component*> _targets;
 
   };
 
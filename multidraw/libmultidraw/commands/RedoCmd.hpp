@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef LIBMULTIDRAW_REDO_CMD_HPP
+#define LIBMULTIDRAW_REDO_CMD_HPP
+
+#include <libmultidraw/commands/Command.hpp>
+
+namespace multidraw {
+
+  /**
+   * @brief Redoes up to steps commands of its Editor's document.
+   *
+   * Multidraw::redo() records one, so that a replay redoes where the
+   * session did. It is not itself undoable.
+   */
+  class RedoCmd : public Command {
+  public:
+    RedoCmd(Editor*, int steps = 1);
+
+    virtual void execute();
+
+    virtual bool reversible() const;
+
+    virtual ClassId classid() const;
+    virtual bool write(Archive&) const;
+    virtual bool read(Archive&);
+
+    int steps() const { return _steps; };
+
+  private:
+    int _steps;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_REDO_CMD_HPP
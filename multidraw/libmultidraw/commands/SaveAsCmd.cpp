@@ -22,6 +22,7 @@
 
 #include <libmultidraw/commands/SaveAsCmd.hpp> // class implemented
 
+#include <libmultidraw/Archive.hpp>
 #include <libmultidraw/Catalog.hpp>
 #include <libmultidraw/Editor.hpp>
 #include <libmultidraw/Multidraw.hpp>
@@ -37,8 +38,33 @@ SaveAsCmd::SaveAsCmd(Editor* editor, const std::string& path) :
 void
 SaveAsCmd::execute()
 {
-  Multidraw::instance()->catalog()->save(editor()->component(), _path);
+  if (Multidraw::instance()->catalog()->save(editor()->component(), _path)) {
+    editor()->outpath(_path);
+    editor()->modified(false);
+  }
 }// execute
 
 bool SaveAsCmd::reversible() { return false; }
 
+
+ClassId SaveAsCmd::classid() const { return SAVE_AS_CMD; }
+
+bool
+SaveAsCmd::write(Archive& archive) const
+{
+  if (!Command::write(archive)) {
+    return false;
+  }
+  archive.write_string(_path);
+  return true;
+}// write
+
+bool
+SaveAsCmd::read(Archive& archive)
+{
+  if (!Command::read(archive)) {
+    return false;
+  }
+  _path = archive.read_string();
+  return archive.good();
+}// read
@@ -40,6 +40,10 @@ namespace multidraw {
 
     virtual bool reversible();
 
+    virtual ClassId classid() const;
+    virtual bool write(Archive&) const;
+    virtual bool read(Archive&);
+
   private:
     std::string _path;
   
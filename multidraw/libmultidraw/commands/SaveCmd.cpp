@@ -36,3 +36,5 @@ SaveCmd::execute()
 }// execute
 
 bool SaveCmd::reversible() { return false; }
+
+ClassId SaveCmd::classid() const { return SAVE_CMD; }
@@ -37,6 +37,8 @@ namespace multidraw {
     virtual void execute();
     
     virtual bool reversible();
+
+    virtual ClassId classid() const;
   
   };
 
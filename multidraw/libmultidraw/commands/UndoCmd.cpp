@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <libmultidraw/commands/UndoCmd.hpp> // class implemented
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/Recorder.hpp>
+
+using namespace multidraw;
+
+UndoCmd::UndoCmd(Editor* editor, int steps) :
+  Command(editor),
+  _steps(steps)
+{
+}// constructor
+
+void
+UndoCmd::execute()
+{
+  if (editor() == nullptr || editor()->component() == nullptr) {
+    return;
+  }
+
+  // Recorded already, as this command.
+  Recorder* recorder = Multidraw::instance()->recorder();
+  if (recorder != nullptr) {
+    recorder->suspend();
+  }
+  Multidraw::instance()->undo(editor()->component(), _steps);
+  if (recorder != nullptr) {
+    recorder->resume();
+  }
+}// execute
+
+bool
+UndoCmd::reversible() const
+{
+  return false;
+}// reversible
+
+ClassId
+UndoCmd::classid() const
+{
+  return UNDO_CMD;
+}// classid
+
+bool
+UndoCmd::write(Archive& archive) const
+{
+  if (!Command::write(archive)) {
+    return false;
+  }
+  archive.write_varint(_steps > 0 ? _steps : 0);
+  return true;
+}// write
+
+bool
+UndoCmd::read(Archive& archive)
+{
+  if (!Command::read(archive)) {
+    return false;
+  }
+  _steps = (int)archive.read_varint();
+  return archive.good();
+}// read
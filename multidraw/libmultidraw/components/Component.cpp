@@ -22,6 +22,9 @@
 
 #include <libmultidraw/components/Component.hpp> // class implemented
 
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/ConstraintNetwork.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
 #include <libmultidraw/tools/Tool.hpp>
 
 #include <algorithm>
@@ -33,10 +36,21 @@ typedef std::vector<Component*> comps;
 Component::Component(const std::string& name) :
   _parent(nullptr),
   _name(name),
-  _visible(false)
+  _visible(false),
+  _touched(true),
+  _network(nullptr),
+  _lifetime(this, [](Component*) { })
 {
 }// constructor
 
+Component::~Component()
+{
+  _lifetime.reset();
+  if (_network != nullptr) {
+    _network->remove(this);
+  }
+}// destructor
+
 Command*
 Component::accept(Tool& tool)
 {
@@ -50,6 +64,7 @@ Component::add_child(Component* comp)
   if (iter == _children.end()) {
     comp->parent(this);
     _children.push_back(comp);
+    touch();
   }
 }// add_child
 
@@ -111,3 +126,120 @@ Component::draw3() const
     }
   }
 }// draw3
+
+std::shared_ptr<const Snapshot>
+Component::snapshot()
+{
+  if (_touched || _snapshot == nullptr) {
+    std::vector<std::shared_ptr<const Snapshot>> children;
+    children.reserve(_children.size());
+    for (auto* child : _children) {
+      children.push_back(child->snapshot());
+    }
+    _snapshot = freeze(std::move(children));
+    _touched = false;
+  }
+  return _snapshot;
+}// snapshot
+
+void
+Component::restore(const std::shared_ptr<const Snapshot>& snap)
+{
+  reload(snap);
+
+  if (_parent != nullptr) {
+    _parent->touch();
+  }
+}// restore
+
+void
+Component::reload(const std::shared_ptr<const Snapshot>& snap)
+{
+  // Untouched since this very version was frozen: nothing to do below here.
+  if (!_touched && _snapshot == snap) {
+    return;
+  }
+
+  _name = snap->name();
+  _visible = snap->visible();
+  thaw(*snap);
+  if (_network != nullptr) {
+    _network->changed(this);
+  }
+
+  _children.clear();
+  for (const auto& version : snap->children()) {
+    // A child deleted since this version was taken cannot come back.
+    Component* child = version->live();
+    if (child == nullptr) {
+      continue;
+    }
+    child->parent(this);
+    child->reload(version);
+    _children.push_back(child);
+  }
+
+  _snapshot = snap;
+  _touched = false;
+}// reload
+
+void
+Component::touch()
+{
+  if (_network != nullptr) {
+    _network->changed(this);
+  }
+
+  // A touched Component always has touched ancestors, so stop at the
+  // first one already marked.
+  for (Component* comp = this; comp != nullptr && !comp->_touched; comp = comp->parent()) {
+    comp->_touched = true;
+  }
+}// touch
+
+ClassId
+Component::classid() const
+{
+  return COMPONENT;
+}// classid
+
+bool
+Component::write(Archive& archive) const
+{
+  archive.write_string(_name);
+  archive.write_varint(_visible ? 1 : 0);
+  archive.write_varint(_children.size());
+  for (const auto* child : _children) {
+    if (!archive.write(*child)) {
+      return false;
+    }
+  }
+  return true;
+}// write
+
+bool
+Component::read(Archive& archive)
+{
+  _name = archive.read_string();
+  _visible = archive.read_varint() != 0;
+
+  // Each child record takes at least five bytes.
+  size_t size = archive.read_varint();
+  if (size > archive.remaining()) {
+    return false;
+  }
+  for (size_t i = 0; i < size && archive.good(); i++) {
+    Component* child = archive.read_component();
+    if (child != nullptr) {
+      add_child(child);
+    }
+  }
+  touch();
+  return archive.good();
+}// read
+
+std::shared_ptr<const Snapshot>
+Component::freeze(std::vector<std::shared_ptr<const Snapshot>> children) const
+{
+  return std::make_shared<const Snapshot>(this, _name, _visible, std::move(children));
+}// freeze
@@ -25,10 +25,16 @@
 
 #include <vector>
 #include <iostream>
+#include <memory>
+
+#include <libmultidraw/ClassId.hpp>
 
 namespace multidraw {
   
+  class Archive;
   class Command;
+  class ConstraintNetwork;
+  class Snapshot;
   class Tool;
 
   /**
@@ -45,7 +51,7 @@ namespace multidraw {
      * @brief Default constructor.
      */
     Component(const std::string& = "");
-    virtual ~Component() {};
+    virtual ~Component();
 
     /// Sub-classes to define the command(s) generated by a user interaction
     virtual Command* accept(Tool&);
@@ -59,11 +65,11 @@ namespace multidraw {
 
     /// Has visibility
     virtual bool visible() const { return _visible; };
-    virtual void visible(bool visible) { _visible = visible; };
+    virtual void visible(bool visible) { _visible = visible; touch(); };
 
     /// Getter & setter for name
     std::string name() const { return _name; };
-    void name(const std::string& name) { _name = name; };
+    void name(const std::string& name) { _name = name; touch(); };
 
     /// how many chidren?
     size_t children_size() const { return _children.size(); };
@@ -77,13 +83,51 @@ namespace multidraw {
 
     virtual void draw2() const;
     virtual void draw3() const;
+
+    /**
+     * Freeze the hierarchy into an immutable version. Subtrees that have
+     * not been touched since the previous call are shared, not copied.
+     */
+    std::shared_ptr<const Snapshot> snapshot();
+
+    /// Return the hierarchy to the state recorded in a snapshot of it.
+    void restore(const std::shared_ptr<const Snapshot>&);
+
+    /// Mark this Component, and so its ancestors, as changed.
+    void touch();
+    bool touched() const { return _touched; };
+
+    /// Expires when this Component is deleted. Snapshots keep it to find their Component again.
+    std::weak_ptr<Component> lifetime() const { return _lifetime; };
+
+    /// The network of Constraints told when this Component is touched, if any.
+    ConstraintNetwork* network() const { return _network; };
+    void network(ConstraintNetwork* network) { _network = network; };
+
+    /// The id an Archive records, and a Creator makes, this class by.
+    virtual ClassId classid() const;
+    /// Write this Component and its children. Sub-classes write their base first.
+    virtual bool write(Archive&) const;
+    /// Fill in a Component made by a Creator from what write() wrote.
+    virtual bool read(Archive&);
   
   protected:
+    /// Sub-classes with state of their own return a derived Snapshot.
+    virtual std::shared_ptr<const Snapshot> freeze(std::vector<std::shared_ptr<const Snapshot>>) const;
+    /// Sub-classes copy their own state back out of the Snapshot from freeze.
+    virtual void thaw(const Snapshot&) { };
+
     std::vector<Component*> _children;
     bool _visible;
   private:
+    void reload(const std::shared_ptr<const Snapshot>&);
+
     std::string _name;
     Component* _parent;
+    bool _touched;
+    ConstraintNetwork* _network;
+    std::shared_ptr<const Snapshot> _snapshot;
+    std::shared_ptr<Component> _lifetime;
 
   };
 
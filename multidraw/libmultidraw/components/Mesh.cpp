@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/components/Mesh.hpp> // class implemented
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+using namespace multidraw;
+
+static uint64_t
+next_id()
+{
+  static std::atomic<uint64_t> ids(0);
+  return ++ids;
+}// next_id
+
+Mesh::Mesh() :
+  _indices(std::make_shared<const Indices>()),
+  _vertices_size(0),
+  _id(next_id()),
+  _revision(0)
+{
+}// constructor
+
+Mesh::Mesh(const std::vector<float>& vertices, Indices indices) :
+  _indices(std::make_shared<const Indices>(std::move(indices))),
+  _vertices_size(0),
+  _id(next_id()),
+  _revision(0)
+{
+  this->vertices(vertices);
+}// constructor
+
+Mesh::Mesh(const Mesh& other) :
+  _chunks(other._chunks),
+  _indices(other._indices),
+  _vertices_size(other._vertices_size),
+  _id(next_id()),
+  _revision(0)
+{
+}// copy constructor
+
+void
+Mesh::vertex(size_t index, float posx, float posy, float posz)
+{
+  auto& chunk = _chunks[index / CHUNK];
+  if (chunk.use_count() > 1) {
+    chunk = std::make_shared<const Chunk>(*chunk);
+  }
+  ++_revision;
+
+  // Unshared, so no other Mesh or Snapshot can observe the write.
+  float* xyz = const_cast<float*>(chunk->data()) + 3 * (index % CHUNK);
+  xyz[0] = posx;
+  xyz[1] = posy;
+  xyz[2] = posz;
+}// vertex
+
+void
+Mesh::vertices(const std::vector<float>& vertices)
+{
+  _vertices_size = vertices.size() / 3;
+
+  _chunks.clear();
+  for (size_t first = 0; first < _vertices_size; first += CHUNK) {
+    size_t last = std::min(first + CHUNK, _vertices_size);
+    _chunks.push_back(std::make_shared<const Chunk>(vertices.begin() + 3 * first, vertices.begin() + 3 * last));
+  }
+  ++_revision;
+}// vertices
+
+void
+Mesh::indices(Indices indices)
+{
+  _indices = std::make_shared<const Indices>(std::move(indices));
+  ++_revision;
+}// indices
+
+size_t
+Mesh::bytes() const
+{
+  size_t bytes = _indices->capacity() * sizeof(uint32_t);
+  for (const auto& chunk : _chunks) {
+    bytes += chunk->capacity() * sizeof(float);
+  }
+  return bytes;
+}// bytes
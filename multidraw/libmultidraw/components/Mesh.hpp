@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_MESH_HPP
+#define LIBMULTIDRAW_MESH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace multidraw {
+
+  /**
+   * @brief An indexed triangle mesh.
+   *
+   * Vertices are x, y, z floats and every three indices form a triangle.
+   * A Mesh is the geometry buffer shared between Components and between
+   * Snapshots. Vertices are stored in fixed-size chunks, each reference
+   * counted, so a copy of a Mesh shares all of its chunks and writing a
+   * vertex copies only the chunk holding it.
+   */
+  class Mesh {
+  public:
+    /// Vertices per chunk.
+    static const size_t CHUNK = 4096;
+
+    using Chunk = std::vector<float>;
+    using Indices = std::vector<uint32_t>;
+
+    Mesh();
+    Mesh(const std::vector<float>& vertices, Indices indices);
+    Mesh(const Mesh&);
+    Mesh& operator=(const Mesh&) = delete;
+
+    size_t vertices_size() const { return _vertices_size; };
+    size_t triangles_size() const { return _indices->size() / 3; };
+
+    /// The x, y, z of a vertex.
+    const float* vertex(size_t index) const
+    {
+      return _chunks[index / CHUNK]->data() + 3 * (index % CHUNK);
+    };
+    /// Move a vertex. Unshares the chunk holding it.
+    void vertex(size_t index, float posx, float posy, float posz);
+
+    void vertices(const std::vector<float>&);
+
+    const Indices& indices() const { return *_indices; };
+    void indices(Indices);
+
+    size_t chunks_size() const { return _chunks.size(); };
+    const std::shared_ptr<const Chunk>& chunk(size_t index) const { return _chunks[index]; };
+    const std::shared_ptr<const Indices>& shared_indices() const { return _indices; };
+
+    /// Bytes held by the vertex and index buffers.
+    size_t bytes() const;
+
+    /// Unique for the lifetime of the process; a copy gets a new one.
+    uint64_t id() const { return _id; };
+    /// Incremented by every write.
+    uint64_t revision() const { return _revision; };
+
+  private:
+    std::vector<std::shared_ptr<const Chunk>> _chunks;
+    std::shared_ptr<const Indices> _indices;
+    size_t _vertices_size;
+    uint64_t _id;
+    uint64_t _revision;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_MESH_HPP
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/components/MeshComponent.hpp> // class implemented
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+
+#include <utility>
+
+using namespace multidraw;
+
+MeshComponent::MeshComponent(const std::string& name, std::shared_ptr<Mesh> mesh) :
+  Component(name),
+  _mesh(std::move(mesh)),
+  _transform(IDENTITY)
+{
+}// constructor
+
+void
+MeshComponent::mesh(std::shared_ptr<Mesh> mesh)
+{
+  _mesh = std::move(mesh);
+  touch();
+}// mesh
+
+void
+MeshComponent::transform(const Transform& transform)
+{
+  _transform = transform;
+  touch();
+}// transform
+
+Mesh&
+MeshComponent::edit()
+{
+  if (_mesh == nullptr) {
+    _mesh = std::make_shared<Mesh>();
+  } else if (_mesh.use_count() > 1) {
+    _mesh = std::make_shared<Mesh>(*_mesh);
+  }
+  touch();
+  return *_mesh;
+}// edit
+
+ClassId
+MeshComponent::classid() const
+{
+  return MESH_COMPONENT;
+}// classid
+
+bool
+MeshComponent::write(Archive& archive) const
+{
+  if (!Component::write(archive)) {
+    return false;
+  }
+
+  for (float value : _transform) {
+    archive.write_float(value);
+  }
+
+  if (_mesh == nullptr) {
+    archive.write_varint(0);
+    return true;
+  }
+  archive.write_varint(1);
+
+  archive.write_varint(_mesh->vertices_size());
+  for (size_t index = 0; index < _mesh->chunks_size(); index++) {
+    for (float value : *_mesh->chunk(index)) {
+      archive.write_float(value);
+    }
+  }
+
+  archive.write_varint(_mesh->indices().size());
+  for (uint32_t value : _mesh->indices()) {
+    archive.write_varint(value);
+  }
+  return true;
+}// write
+
+bool
+MeshComponent::read(Archive& archive)
+{
+  if (!Component::read(archive)) {
+    return false;
+  }
+
+  for (float& value : _transform) {
+    value = archive.read_float();
+  }
+
+  if (archive.read_varint() == 0) {
+    _mesh = nullptr;
+    return archive.good();
+  }
+
+  // Check counts against what is left before allocating for them.
+  size_t size = archive.read_varint();
+  if (size > archive.remaining() / (3 * sizeof(float))) {
+    return false;
+  }
+  std::vector<float> vertices(3 * size);
+  for (float& value : vertices) {
+    value = archive.read_float();
+  }
+
+  size = archive.read_varint();
+  if (size > archive.remaining()) {
+    return false;
+  }
+  // An index past the vertices would have the renderers read out of bounds.
+  size_t count = vertices.size() / 3;
+  Mesh::Indices indices(size);
+  for (uint32_t& value : indices) {
+    uint64_t index = archive.read_varint();
+    if (index >= count) {
+      return false;
+    }
+    value = (uint32_t)index;
+  }
+
+  _mesh = std::make_shared<Mesh>(vertices, std::move(indices));
+  touch();
+  return archive.good();
+}// read
+
+std::shared_ptr<const Snapshot>
+MeshComponent::freeze(std::vector<std::shared_ptr<const Snapshot>> children) const
+{
+  return std::make_shared<const MeshSnapshot>(this, name(), _visible, std::move(children), _mesh, _transform);
+}// freeze
+
+void
+MeshComponent::thaw(const Snapshot& snap)
+{
+  const auto* version = dynamic_cast<const MeshSnapshot*>(&snap);
+  if (version != nullptr) {
+    // The snapshot never mutates its buffer; edit() unshares before writing.
+    _mesh = std::const_pointer_cast<Mesh>(version->mesh());
+    _transform = version->transform();
+  }
+}// thaw
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_MESH_COMPONENT_HPP
+#define LIBMULTIDRAW_MESH_COMPONENT_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+namespace multidraw {
+
+  class Mesh;
+
+  /// Column-major 4x4 matrix, as consumed by OpenGL.
+  using Transform = std::array<float, 16>;
+
+  const Transform IDENTITY = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+  /**
+   * @brief A Snapshot of a MeshComponent, sharing its geometry buffer.
+   */
+  class MeshSnapshot : public Snapshot {
+  public:
+    MeshSnapshot(const Component* comp,
+                 const std::string& name,
+                 bool visible,
+                 Children children,
+                 std::shared_ptr<const Mesh> mesh,
+                 const Transform& transform) :
+      Snapshot(comp, name, visible, std::move(children)),
+      _mesh(std::move(mesh)),
+      _transform(transform) {};
+
+    const std::shared_ptr<const Mesh>& mesh() const { return _mesh; };
+    const Transform& transform() const { return _transform; };
+
+  private:
+    std::shared_ptr<const Mesh> _mesh;
+    Transform _transform;
+  };
+
+  /**
+   * @brief A Component with triangle geometry.
+   *
+   * The Mesh is copy-on-write: it may be shared with other Components and
+   * with Snapshots, and edit() makes a private copy before handing out a
+   * mutable reference to a shared buffer.
+   */
+  class MeshComponent : public Component {
+  public:
+    MeshComponent(const std::string& = "", std::shared_ptr<Mesh> = nullptr);
+
+    const Mesh* mesh() const { return _mesh.get(); };
+    std::shared_ptr<const Mesh> shared_mesh() const { return _mesh; };
+    void mesh(std::shared_ptr<Mesh>);
+
+    /// Mutable access to the geometry, unsharing it first if necessary.
+    Mesh& edit();
+
+    /// Placement of the Mesh in world coordinates.
+    const Transform& transform() const { return _transform; };
+    void transform(const Transform&);
+
+    virtual ClassId classid() const;
+    virtual bool write(Archive&) const;
+    virtual bool read(Archive&);
+
+  protected:
+    virtual std::shared_ptr<const Snapshot> freeze(std::vector<std::shared_ptr<const Snapshot>>) const;
+    virtual void thaw(const Snapshot&);
+
+  private:
+    std::shared_ptr<Mesh> _mesh;
+    Transform _transform;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_MESH_COMPONENT_HPP
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_SNAPSHOT_HPP
+#define LIBMULTIDRAW_SNAPSHOT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace multidraw {
+
+  class Component;
+
+  /**
+   * @brief An immutable, reference-counted version of a Component.
+   *
+   * Snapshots are built by Component::snapshot(). A node that has not been
+   * touched since the previous snapshot is reused as is, so consecutive
+   * versions of a tree share every unchanged subtree. Snapshots may be read
+   * from any thread.
+   */
+  class Snapshot {
+  public:
+    using Children = std::vector<std::shared_ptr<const Snapshot>>;
+
+    Snapshot(const Component*, const std::string&, bool, Children);
+    virtual ~Snapshot() = default;
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /// The Component this version was taken from. Only an identity; it may be gone.
+    const Component* component() const { return _component; };
+    /// That Component, or nullptr once it has been deleted.
+    Component* live() const { return _live.lock().get(); };
+
+    const std::string& name() const { return _name; };
+    bool visible() const { return _visible; };
+
+    size_t children_size() const { return _children.size(); };
+    const Snapshot* child(size_t index) const;
+    const Children& children() const { return _children; };
+
+  private:
+    const Component* _component;
+    std::weak_ptr<Component> _live;
+    std::string _name;
+    bool _visible;
+    Children _children;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_SNAPSHOT_HPP
@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define GL_GLEXT_PROTOTYPES
+
+#include <libmultidraw/renderers/BufferCache.hpp> // class implemented
+
+#include <libmultidraw/components/MeshComponent.hpp>
+
+#include <FL/gl.h>
+#include <GL/glext.h>
+
+#include <algorithm>
+#include <array>
+
+using namespace multidraw;
+
+const size_t XYZ = 3 * sizeof(float);
+const uint64_t STALE = UINT64_MAX;
+/// Cells along each axis of the grid a coarse level snaps vertices to.
+const size_t GRID = 32;
+const uint32_t EMPTY = UINT32_MAX;
+
+using Triangle = std::array<uint32_t, 3>;
+
+/// Turned so the least index comes first, keeping the winding.
+static Triangle
+canonical(uint32_t a, uint32_t b, uint32_t c)
+{
+  if (b < a && b < c) {
+    return Triangle{b, c, a};
+  }
+  if (c < a && c < b) {
+    return Triangle{c, a, b};
+  }
+  return Triangle{a, b, c};
+}// canonical
+
+BufferCache::BufferCache() :
+  _frame(0),
+  _serial(0),
+  _bytes(0),
+  _uploads(0)
+{
+}// constructor
+
+BufferCache::Buffers*
+BufferCache::find(const MeshSnapshot& snap)
+{
+  auto iter = _buffers.find(snap.mesh()->id());
+  if (iter == _buffers.end()) {
+    return nullptr;
+  }
+
+  iter->second.frame = _frame;
+  _drawn[snap.component()] = iter->first;
+  return &iter->second;
+}// find
+
+BufferCache::Buffers*
+BufferCache::acquire(const MeshSnapshot& snap)
+{
+  uint64_t id = snap.mesh()->id();
+
+  // Acquired already for an earlier Component sharing the Mesh.
+  Buffers* shared = find(snap);
+  if (shared != nullptr) {
+    return shared;
+  }
+
+  // Take over the buffers this Component drew last frame, if nothing
+  // else drew them this frame; most of the chunks are likely the same.
+  auto drawn = _drawn.find(snap.component());
+  if (drawn != _drawn.end()) {
+    auto iter = _buffers.find(drawn->second);
+    if (iter != _buffers.end() && iter->second.frame != _frame) {
+      auto node = _buffers.extract(iter);
+      node.key() = id;
+      iter = _buffers.insert(std::move(node)).position;
+      iter->second.mesh = snap.mesh();
+      iter->second.revision = STALE;
+      iter->second.coarse_revision = STALE;
+      iter->second.frame = _frame;
+      drawn->second = id;
+      return &iter->second;
+    }
+  }
+
+  Buffers& buffers = _buffers[id];
+  buffers.mesh = snap.mesh();
+  buffers.serial = ++_serial;
+  buffers.revision = STALE;
+  buffers.coarse_revision = STALE;
+  buffers.frame = _frame;
+  _drawn[snap.component()] = id;
+
+  glGenBuffers(1, &buffers.vbo);
+  glGenBuffers(1, &buffers.ibo);
+
+  return &buffers;
+}// acquire
+
+size_t
+BufferCache::upload(Buffers& buffers, const std::shared_ptr<const Mesh>& mesh)
+{
+  if (buffers.revision == mesh->revision()) {
+    return 0;
+  }
+
+  size_t uploaded = 0;
+  glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo);
+
+  if (buffers.vertices != mesh->vertices_size()) {
+    _bytes -= buffers.vertices * XYZ;
+    buffers.vertices = mesh->vertices_size();
+    _bytes += buffers.vertices * XYZ;
+    buffers.chunks.clear();
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(buffers.vertices * XYZ), nullptr, GL_DYNAMIC_DRAW);
+  }
+  buffers.chunks.resize(mesh->chunks_size());
+
+  for (size_t index = 0; index < mesh->chunks_size(); ++index) {
+    const auto& chunk = mesh->chunk(index);
+    if (buffers.chunks[index] != chunk) {
+      size_t bytes = chunk->size() * sizeof(float);
+      glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(index * Mesh::CHUNK * XYZ), (GLsizeiptr)bytes, chunk->data());
+      buffers.chunks[index] = chunk;
+      _uploads++;
+      uploaded += bytes;
+    }
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  if (buffers.elements != mesh->shared_indices()) {
+    const auto& indices = mesh->indices();
+    size_t bytes = indices.size() * sizeof(uint32_t);
+
+    // With no vertex array bound, so none of the renderers' is changed.
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)bytes, indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    _bytes -= buffers.indices * sizeof(uint32_t);
+    buffers.elements = mesh->shared_indices();
+    buffers.indices = indices.size();
+    _bytes += bytes;
+    _uploads++;
+    uploaded += bytes;
+  }
+
+  buffers.revision = mesh->revision();
+  return uploaded;
+}// upload
+
+size_t
+BufferCache::coarsen(Buffers& buffers, const Mesh& mesh)
+{
+  if (buffers.coarsened()) {
+    return 0;
+  }
+
+  // Vertex clustering: snap each vertex to the first one in its grid
+  // cell, and keep the triangles whose corners still differ.
+  float low[3] = {0.0F, 0.0F, 0.0F};
+  float high[3] = {0.0F, 0.0F, 0.0F};
+  for (size_t index = 0; index < mesh.vertices_size(); ++index) {
+    const float* xyz = mesh.vertex(index);
+    for (size_t axis = 0; axis < 3; ++axis) {
+      low[axis] = index == 0 ? xyz[axis] : std::min(low[axis], xyz[axis]);
+      high[axis] = index == 0 ? xyz[axis] : std::max(high[axis], xyz[axis]);
+    }
+  }
+  float extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+  float scale = extent > 0.0F ? (float)(GRID - 1) / extent : 0.0F;
+
+  std::vector<uint32_t> cells(GRID * GRID * GRID, EMPTY);
+  std::vector<uint32_t> snapped(mesh.vertices_size());
+  for (size_t index = 0; index < mesh.vertices_size(); ++index) {
+    const float* xyz = mesh.vertex(index);
+    size_t cell = 0;
+    for (size_t axis = 0; axis < 3; ++axis) {
+      cell = cell * GRID + (size_t)((xyz[axis] - low[axis]) * scale);
+    }
+    if (cells[cell] == EMPTY) {
+      cells[cell] = (uint32_t)index;
+    }
+    snapped[index] = cells[cell];
+  }
+
+  std::vector<Triangle> triangles;
+  const auto& indices = mesh.indices();
+  for (size_t index = 0; index + 2 < indices.size(); index += 3) {
+    uint32_t a = snapped[indices[index]];
+    uint32_t b = snapped[indices[index + 1]];
+    uint32_t c = snapped[indices[index + 2]];
+    if (a != b && b != c && c != a) {
+      triangles.push_back(canonical(a, b, c));
+    }
+  }
+  // Many fine triangles snap onto the same coarse one.
+  std::sort(triangles.begin(), triangles.end());
+  triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+  size_t bytes = triangles.size() * sizeof(Triangle);
+  if (buffers.coarse == 0) {
+    glGenBuffers(1, &buffers.coarse);
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.coarse);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)bytes, triangles.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  _bytes -= buffers.coarse_indices * sizeof(uint32_t);
+  buffers.coarse_indices = triangles.size() * 3;
+  buffers.coarse_revision = buffers.revision;
+  _bytes += bytes;
+  _uploads++;
+  return bytes;
+}// coarsen
+
+void
+BufferCache::destroy(Buffers& buffers)
+{
+  glDeleteBuffers(1, &buffers.vbo);
+  glDeleteBuffers(1, &buffers.ibo);
+  glDeleteBuffers(1, &buffers.coarse);
+  _bytes -= (buffers.vertices * XYZ) + (buffers.indices + buffers.coarse_indices) * sizeof(uint32_t);
+}// destroy
+
+void
+BufferCache::sweep()
+{
+  for (auto iter = _buffers.begin(); iter != _buffers.end(); ) {
+    if (iter->second.frame != _frame && iter->second.mesh.expired()) {
+      destroy(iter->second);
+      iter = _buffers.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+
+  for (auto iter = _drawn.begin(); iter != _drawn.end(); ) {
+    if (_buffers.find(iter->second) == _buffers.end()) {
+      iter = _drawn.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+}// sweep
+
+void
+BufferCache::release()
+{
+  for (auto& [id, buffers] : _buffers) {
+    destroy(buffers);
+  }
+  reset();
+}// release
+
+void
+BufferCache::reset()
+{
+  _buffers.clear();
+  _drawn.clear();
+  _bytes = 0;
+}// reset
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_BUFFER_CACHE_HPP
+#define LIBMULTIDRAW_BUFFER_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <libmultidraw/components/Mesh.hpp>
+
+namespace multidraw {
+
+  class Component;
+  class MeshSnapshot;
+
+  /**
+   * @brief The vertex and index buffers of the Meshes an Editor shows.
+   *
+   * FLTK puts every GL context in one share group, so buffers uploaded
+   * while one Viewer's context is current can be drawn from any other.
+   * The RetainedRenderers of all of an Editor's Viewers share one cache,
+   * and each Mesh is uploaded once however many Viewers show it. Vertex
+   * arrays are not shared between contexts, so each renderer binds its
+   * own to these buffers.
+   *
+   * A Mesh may also have a coarse level: an index buffer of fewer,
+   * larger triangles over the same vertices, drawn while the view moves.
+   *
+   * Every call must be made with a context of the share group current.
+   */
+  class BufferCache {
+  public:
+    struct Buffers {
+      std::weak_ptr<const Mesh> mesh;
+      /// Never reused, unlike GL names; renderers key their vertex arrays by it.
+      uint64_t serial;
+      unsigned int vbo;
+      unsigned int ibo;
+      size_t vertices;
+      size_t indices;
+      uint64_t revision;
+      uint64_t frame;
+      std::vector<std::shared_ptr<const Mesh::Chunk>> chunks;
+      std::shared_ptr<const Mesh::Indices> elements;
+      /// The coarse level's index buffer, or 0 if never built.
+      unsigned int coarse;
+      size_t coarse_indices;
+      /// The revision the coarse level was built from.
+      uint64_t coarse_revision;
+
+      /// The coarse level matches the uploaded Mesh.
+      bool coarsened() const { return coarse != 0 && coarse_revision == revision; };
+    };
+
+    BufferCache();
+    ~BufferCache() = default;
+
+    BufferCache(const BufferCache&) = delete;
+    BufferCache& operator=(const BufferCache&) = delete;
+
+    /// Start drawing a frame in one Viewer.
+    void begin() { _frame++; };
+
+    /// The buffers of a resident Mesh, marked as drawn this frame, or nullptr.
+    Buffers* find(const MeshSnapshot&);
+    /**
+     * Buffers for a Mesh that is not resident. Those the Component drew
+     * before are taken over, if nothing has drawn them this frame.
+     */
+    Buffers* acquire(const MeshSnapshot&);
+    /// Bring the buffers up to date with a Mesh. Returns the bytes uploaded.
+    size_t upload(Buffers&, const std::shared_ptr<const Mesh>&);
+    /// Build the coarse level of uploaded buffers. Returns the bytes uploaded.
+    size_t coarsen(Buffers&, const Mesh&);
+    /// Delete the buffers of Meshes that are gone.
+    void sweep();
+
+    /// Delete every buffer.
+    void release();
+    /// Forget buffers that were destroyed along with their share group.
+    void reset();
+
+    /// Meshes resident.
+    size_t size() const { return _buffers.size(); };
+    /// Bytes held in GPU buffers.
+    size_t bytes() const { return _bytes; };
+    /// Buffer uploads since construction.
+    size_t uploads() const { return _uploads; };
+
+  private:
+    void destroy(Buffers&);
+
+    std::unordered_map<uint64_t, Buffers> _buffers;
+    std::unordered_map<const Component*, uint64_t> _drawn;
+    uint64_t _frame;
+    uint64_t _serial;
+    size_t _bytes;
+    size_t _uploads;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_BUFFER_CACHE_HPP
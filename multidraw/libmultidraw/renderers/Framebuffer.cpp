@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/renderers/Framebuffer.hpp> // class implemented
+
+#include <algorithm>
+
+using namespace multidraw;
+
+Framebuffer::Framebuffer(int width, int height) :
+  _width(0),
+  _height(0)
+{
+  resize(width, height);
+}// constructor
+
+void
+Framebuffer::resize(int width, int height)
+{
+  _width = std::max(0, width);
+  _height = std::max(0, height);
+  _color.resize((size_t)_width * _height);
+  _depth.resize((size_t)_width * _height);
+}// resize
+
+void
+Framebuffer::clear(uint32_t rgba, float depth)
+{
+  std::fill(_color.begin(), _color.end(), rgba);
+  std::fill(_depth.begin(), _depth.end(), depth);
+}// clear
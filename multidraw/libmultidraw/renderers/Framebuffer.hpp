@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_FRAMEBUFFER_HPP
+#define LIBMULTIDRAW_FRAMEBUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace multidraw {
+
+  /**
+   * @brief Color and depth images in memory.
+   *
+   * Rows run top to bottom. Each pixel is RGBA, one byte per channel in
+   * that order, packed into a uint32_t.
+   */
+  class Framebuffer {
+  public:
+    Framebuffer(int width, int height);
+
+    int width() const { return _width; };
+    int height() const { return _height; };
+    void resize(int width, int height);
+
+    void clear(uint32_t rgba, float depth);
+
+    uint32_t* color() { return _color.data(); };
+    const uint32_t* color() const { return _color.data(); };
+    float* depth() { return _depth.data(); };
+    const float* depth() const { return _depth.data(); };
+
+    uint32_t pixel(int posx, int posy) const { return _color[(size_t)posy * _width + posx]; };
+
+    static uint32_t rgba(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = 255)
+    {
+      return (uint32_t)red | ((uint32_t)green << 8) | ((uint32_t)blue << 16) | ((uint32_t)alpha << 24);
+    };
+
+  private:
+    int _width;
+    int _height;
+    std::vector<uint32_t> _color;
+    std::vector<float> _depth;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_FRAMEBUFFER_HPP
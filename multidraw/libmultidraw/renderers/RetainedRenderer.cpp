@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define GL_GLEXT_PROTOTYPES
+
+#include <libmultidraw/renderers/RetainedRenderer.hpp> // class implemented
+
+#include <libmultidraw/components/MeshComponent.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+#include <FL/gl.h>
+#include <GL/glext.h>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace multidraw;
+
+const float GREY = 0.8F;
+/// Meshes with fewer triangles are always drawn in full.
+const size_t COARSEST = 4096;
+const size_t BUDGET = 1000000;
+const size_t MATRIX = 16;
+/// Generic attributes 4 to 7 hold the columns of an instance's transform.
+const GLuint COLUMN = 4;
+
+const char* const VERTEX_SHADER =
+  "#version 130\n"
+  "in vec4 column0;\n"
+  "in vec4 column1;\n"
+  "in vec4 column2;\n"
+  "in vec4 column3;\n"
+  "void main() {\n"
+  "  mat4 model = mat4(column0, column1, column2, column3);\n"
+  "  gl_Position = gl_ModelViewProjectionMatrix * model * gl_Vertex;\n"
+  "  gl_FrontColor = gl_Color;\n"
+  "}\n";
+
+const char* const FRAGMENT_SHADER =
+  "#version 130\n"
+  "void main() {\n"
+  "  gl_FragColor = gl_Color;\n"
+  "}\n";
+
+static GLuint
+compile(GLenum type, const char* source)
+{
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (compiled == GL_FALSE) {
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}// compile
+
+RetainedRenderer::RetainedRenderer(std::shared_ptr<BufferCache> cache) :
+  _cache(cache != nullptr ? std::move(cache) : std::make_shared<BufferCache>()),
+  _instancing(true),
+  _program(0),
+  _unbuildable(false),
+  _instances(0),
+  _progressive(false),
+  _interactive(false),
+  _budget(BUDGET),
+  _spent(0),
+  _refining(false),
+  _frame(0),
+  _stats()
+{
+}// constructor
+
+void
+RetainedRenderer::render(const Snapshot& root)
+{
+  _stats = Stats();
+  _spent = 0;
+  _refining = false;
+  _frame++;
+  _cache->begin();
+
+  auto start = std::chrono::steady_clock::now();
+  _items.clear();
+  collect(root);
+  _stats.traversal = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Meshes already resident first, so that a replaced Mesh only takes
+  // over buffers no other Component is still drawing.
+  for (auto& item : _items) {
+    item.buffers = _cache->find(*item.snapshot);
+  }
+
+  size_t uploads = _cache->uploads();
+  for (auto& item : _items) {
+    if (item.buffers == nullptr) {
+      item.buffers = _cache->acquire(*item.snapshot);
+    }
+    _stats.uploaded += _cache->upload(*item.buffers, item.snapshot->mesh());
+  }
+
+  // Components sharing buffers next to each other, each run one draw.
+  bool instanced = _instancing && build();
+  if (instanced) {
+    std::stable_sort(_items.begin(), _items.end(), [](const Item& a, const Item& b) {
+      return a.buffers->serial < b.buffers->serial;
+    });
+
+    _transforms.clear();
+    for (const auto& item : _items) {
+      const auto& transform = item.snapshot->transform();
+      _transforms.insert(_transforms.end(), transform.cbegin(), transform.cend());
+    }
+    if (_instances == 0) {
+      glGenBuffers(1, &_instances);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, _instances);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(_transforms.size() * sizeof(float)), _transforms.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  glEnable(GL_DEPTH_TEST);
+  glColor3f(GREY, GREY, GREY);
+  glMatrixMode(GL_MODELVIEW);
+
+  for (size_t first = 0; first < _items.size(); ) {
+    size_t last = first + 1;
+    while (instanced && last < _items.size() && _items[last].buffers == _items[first].buffers) {
+      last++;
+    }
+    draw(_items.data() + first, _items.data() + last, first);
+    first = last;
+  }
+
+  glBindVertexArray(0);
+  glDisable(GL_DEPTH_TEST);
+  _stats.uploads = _cache->uploads() - uploads;
+
+  // Nothing is deleted mid-gesture; it can wait for the view to settle.
+  if (!(_progressive && _interactive)) {
+    sweep();
+  }
+}// render
+
+void
+RetainedRenderer::collect(const Snapshot& snap)
+{
+  if (!snap.visible()) {
+    _stats.culled++;
+    return;
+  }
+
+  const auto* meshed = dynamic_cast<const MeshSnapshot*>(&snap);
+  if (meshed != nullptr) {
+    if (meshed->mesh() != nullptr && !meshed->mesh()->indices().empty()) {
+      _items.push_back(Item { meshed, nullptr });
+    } else {
+      _stats.culled++;
+    }
+  }
+
+  for (const auto& child : snap.children()) {
+    collect(*child);
+  }
+}// collect
+
+unsigned int
+RetainedRenderer::bind(const BufferCache::Buffers& buffers)
+{
+  Array& array = _arrays[buffers.serial];
+  array.frame = _frame;
+  if (array.vao != 0) {
+    return array.vao;
+  }
+
+  glGenVertexArrays(1, &array.vao);
+  glBindVertexArray(array.vao);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, nullptr);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ibo);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return array.vao;
+}// bind
+
+bool
+RetainedRenderer::coarse(BufferCache::Buffers& buffers, Array& array, const Mesh& mesh)
+{
+  size_t triangles = buffers.indices / 3;
+  if (!_progressive || triangles < COARSEST) {
+    array.coarse = false;
+    return false;
+  }
+
+  if (_interactive) {
+    // Only levels built beforehand; a Mesh being edited is drawn in full.
+    array.coarse = buffers.coarsened();
+    return array.coarse;
+  }
+
+  if (array.coarse && buffers.coarsened() && !afford(triangles)) {
+    _refining = true;
+    return true;
+  }
+  array.coarse = false;
+
+  // Ready for the next gesture.
+  if (!buffers.coarsened()) {
+    if (afford(triangles)) {
+      _stats.uploaded += _cache->coarsen(buffers, mesh);
+    } else {
+      _refining = true;
+    }
+  }
+  return false;
+}// coarse
+
+bool
+RetainedRenderer::afford(size_t triangles)
+{
+  if (_budget > 0 && _spent > 0 && _spent + triangles > _budget) {
+    return false;
+  }
+  _spent += triangles;
+  return true;
+}// afford
+
+void
+RetainedRenderer::draw(const Item* first, const Item* last, size_t instance)
+{
+  BufferCache::Buffers& buffers = *first->buffers;
+  auto count = (size_t)(last - first);
+
+  // Chosen before binding, since building a coarse level unbinds it.
+  bool coarsely = coarse(buffers, _arrays[buffers.serial], *first->snapshot->mesh());
+  glBindVertexArray(bind(buffers));
+
+  // The coarse level shares the vertex buffer; only the indices differ.
+  size_t indices = buffers.indices;
+  if (coarsely) {
+    indices = buffers.coarse_indices;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.coarse);
+    _stats.coarse += count;
+  }
+
+  if (count == 1) {
+    glPushMatrix();
+    glMultMatrixf(first->snapshot->transform().data());
+    glDrawElements(GL_TRIANGLES, (GLsizei)indices, GL_UNSIGNED_INT, nullptr);
+    glPopMatrix();
+  } else {
+    // Point the instance attributes at this run's transforms.
+    glBindBuffer(GL_ARRAY_BUFFER, _instances);
+    for (GLuint column = 0; column < 4; column++) {
+      size_t offset = (instance * MATRIX + column * 4) * sizeof(float);
+      glEnableVertexAttribArray(COLUMN + column);
+      glVertexAttribPointer(COLUMN + column, 4, GL_FLOAT, GL_FALSE, MATRIX * sizeof(float), (const void*)offset);
+      glVertexAttribDivisor(COLUMN + column, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(_program);
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)indices, GL_UNSIGNED_INT, nullptr, (GLsizei)count);
+    glUseProgram(0);
+
+    for (GLuint column = 0; column < 4; column++) {
+      glDisableVertexAttribArray(COLUMN + column);
+    }
+  }
+
+  // The binding belongs to the vertex array, which the next draw reuses.
+  if (coarsely) {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ibo);
+  }
+
+  _stats.draws++;
+  _stats.instances += count;
+  _stats.triangles += count * (indices / 3);
+}// draw
+
+bool
+RetainedRenderer::build()
+{
+  if (_program != 0 || _unbuildable) {
+    return _program != 0;
+  }
+
+  GLuint vertex = compile(GL_VERTEX_SHADER, VERTEX_SHADER);
+  GLuint fragment = compile(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+  if (vertex != 0 && fragment != 0) {
+    _program = glCreateProgram();
+    glAttachShader(_program, vertex);
+    glAttachShader(_program, fragment);
+    glBindAttribLocation(_program, COLUMN + 0, "column0");
+    glBindAttribLocation(_program, COLUMN + 1, "column1");
+    glBindAttribLocation(_program, COLUMN + 2, "column2");
+    glBindAttribLocation(_program, COLUMN + 3, "column3");
+    glLinkProgram(_program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+      glDeleteProgram(_program);
+      _program = 0;
+    }
+  }
+  // Flagged for deletion now, deleted with the program.
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+
+  _unbuildable = _program == 0;
+  return !_unbuildable;
+}// build
+
+void
+RetainedRenderer::sweep()
+{
+  // Arrays not drawn this frame may bind buffers the cache has deleted.
+  for (auto iter = _arrays.begin(); iter != _arrays.end(); ) {
+    if (iter->second.frame != _frame) {
+      glDeleteVertexArrays(1, &iter->second.vao);
+      iter = _arrays.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+
+  _cache->sweep();
+}// sweep
+
+void
+RetainedRenderer::release()
+{
+  for (auto& [serial, array] : _arrays) {
+    glDeleteVertexArrays(1, &array.vao);
+  }
+  _arrays.clear();
+  _items.clear();
+
+  glDeleteProgram(_program);
+  glDeleteBuffers(1, &_instances);
+  _program = 0;
+  _instances = 0;
+
+  if (_cache.use_count() == 1) {
+    _cache->release();
+  }
+}// release
+
+void
+RetainedRenderer::reset()
+{
+  _arrays.clear();
+  _items.clear();
+  _program = 0;
+  _instances = 0;
+  _unbuildable = false;
+
+  // The share group only outlives this context if another renderer's is in it.
+  if (_cache.use_count() == 1) {
+    _cache->reset();
+  }
+}// reset
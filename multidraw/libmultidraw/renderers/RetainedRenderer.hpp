@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_RETAINED_RENDERER_HPP
+#define LIBMULTIDRAW_RETAINED_RENDERER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <libmultidraw/renderers/BufferCache.hpp>
+
+namespace multidraw {
+
+  class MeshSnapshot;
+  class Snapshot;
+
+  /**
+   * @brief Draws a Snapshot from GPU-resident vertex and index buffers.
+   *
+   * Each Mesh is uploaded once into a VBO/IBO pair held in a BufferCache,
+   * which the renderers of an Editor's Viewers share. Later frames
+   * re-upload only the vertex chunks that changed, found by comparing
+   * chunk identity, including when a Component's Mesh has been replaced
+   * by an edited copy. Buffers are released when their Mesh is. Each
+   * renderer keeps only its own context's VAOs, so another view of the
+   * same document costs a handful of GL names, not another copy of it.
+   *
+   * Components sharing a Mesh, such as a set of identical brackets, are
+   * drawn together by one instanced draw, with their transforms in a
+   * per-instance attribute read by a small shader. Should the shader not
+   * build, each is drawn on its own.
+   *
+   * In progressive mode, large meshes are drawn at their coarse level
+   * while the view is interactive, and the garbage collection of GL
+   * objects waits. Once it is not, each frame refines meshes back to
+   * full detail, and builds the coarse levels missing, up to a budget
+   * of triangles; refining() tells whether another frame is needed.
+   *
+   * Only OpenGL 3.3 compatibility profile entry points are used, so the
+   * renderer runs under Mesa llvmpipe. It draws into whichever context is
+   * current, leaving the projection and modelview matrices to the caller.
+   */
+  class RetainedRenderer {
+  public:
+    struct Stats {
+      /// Draw calls, counting an instanced draw once.
+      size_t draws;
+      /// Meshes drawn, each instance counting once.
+      size_t instances;
+      /// Of which at their coarse level.
+      size_t coarse;
+      size_t triangles;
+      /// Meshes skipped: hidden subtrees count once, as do empty meshes.
+      size_t culled;
+      size_t uploads;
+      size_t uploaded;
+      /// Seconds spent walking the Snapshot.
+      double traversal;
+    };
+
+    /// Shares the buffers of a cache, or makes one of its own.
+    explicit RetainedRenderer(std::shared_ptr<BufferCache> = nullptr);
+    ~RetainedRenderer() = default;
+
+    RetainedRenderer(const RetainedRenderer&) = delete;
+    RetainedRenderer& operator=(const RetainedRenderer&) = delete;
+
+    /// Draw the visible meshes of a hierarchy into the current context.
+    void render(const Snapshot&);
+
+    /// Delete this context's GL objects, and the cache's if no other renderer shares it.
+    void release();
+
+    /// Forget GL objects that were destroyed along with their context.
+    void reset();
+
+    const std::shared_ptr<BufferCache>& cache() const { return _cache; };
+
+    /// Draw Components that share a Mesh with one instanced draw. On by default.
+    bool instancing() const { return _instancing; };
+    void instancing(bool instancing) { _instancing = instancing; };
+
+    /// Draw coarse levels while interactive, and refine after. Off by default.
+    bool progressive() const { return _progressive; };
+    void progressive(bool progressive) { _progressive = progressive; };
+    /// The view is moving, so speed matters more than detail.
+    bool interactive() const { return _interactive; };
+    void interactive(bool interactive) { _interactive = interactive; };
+    /// Triangles refined or coarsened per frame, at least one mesh's; 0 for no limit.
+    size_t budget() const { return _budget; };
+    void budget(size_t triangles) { _budget = triangles; };
+    /// The last render() left meshes to refine or coarsen.
+    bool refining() const { return _refining; };
+
+    /// Counters for the most recent render().
+    const Stats& stats() const { return _stats; };
+
+  private:
+    struct Item {
+      const MeshSnapshot* snapshot;
+      BufferCache::Buffers* buffers;
+    };
+
+    struct Array {
+      unsigned int vao;
+      uint64_t frame;
+      /// Drawn at the coarse level, and not refined since.
+      bool coarse;
+    };
+
+    void collect(const Snapshot&);
+    unsigned int bind(const BufferCache::Buffers&);
+    bool coarse(BufferCache::Buffers&, Array&, const Mesh&);
+    bool afford(size_t triangles);
+    bool build();
+    void draw(const Item*, const Item*, size_t instance);
+    void sweep();
+
+    std::shared_ptr<BufferCache> _cache;
+    /// This context's vertex arrays, by BufferCache::Buffers::serial.
+    std::unordered_map<uint64_t, Array> _arrays;
+    std::vector<Item> _items;
+    /// Column-major transforms of the Components drawn instanced.
+    std::vector<float> _transforms;
+    bool _instancing;
+    /// The instancing shader, or 0 if not built.
+    unsigned int _program;
+    /// Building the shader failed once, so it is not tried again.
+    bool _unbuildable;
+    unsigned int _instances;
+    bool _progressive;
+    bool _interactive;
+    size_t _budget;
+    /// Triangles refined or coarsened this frame.
+    size_t _spent;
+    bool _refining;
+    uint64_t _frame;
+    Stats _stats;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_RETAINED_RENDERER_HPP
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/renderers/SoftwareRenderer.hpp> // class implemented
+
+#include <libmultidraw/Camera.hpp>
+#include <libmultidraw/JobSystem.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+#include <libmultidraw/renderers/Framebuffer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace multidraw;
+
+// Same shades as Viewer and RetainedRenderer.
+const uint32_t BACKGROUND = Framebuffer::rgba(128, 128, 128);
+const float GREY = 0.8F;
+const float AMBIENT = 0.25F;
+const float FAR = std::numeric_limits<float>::max();
+const float CLIPZ = (float)Camera::CLIPZ;
+const size_t SLICES_PER_THREAD = 4;
+
+SoftwareRenderer::SoftwareRenderer(JobSystem* jobs) :
+  _jobs(jobs),
+  _slices(0),
+  _tiles_x(0),
+  _tiles_y(0),
+  _stats()
+{
+}// constructor
+
+void
+SoftwareRenderer::render(const Snapshot& root, const Camera& camera, Framebuffer& framebuffer)
+{
+  int width = framebuffer.width();
+  int height = framebuffer.height();
+  JobSystem& jobs = _jobs != nullptr ? *_jobs : Multidraw::instance()->jobs();
+
+  _stats = Stats();
+  framebuffer.clear(BACKGROUND, FAR);
+
+  _items.clear();
+  collect(root);
+
+  _vertices.assign(1, 0);
+  _triangles.assign(1, 0);
+  for (const auto* item : _items) {
+    _vertices.push_back(_vertices.back() + item->mesh()->vertices_size());
+    _triangles.push_back(_triangles.back() + item->mesh()->triangles_size());
+  }
+  _stats.triangles = _triangles.back();
+
+  if (_stats.triangles == 0 || width == 0 || height == 0) {
+    return;
+  }
+
+  // Project every vertex once, a Mesh chunk at a time.
+  _screen.resize(3 * _vertices.back());
+  _chunks.clear();
+  for (size_t item = 0; item < _items.size(); ++item) {
+    for (size_t chunk = 0; chunk < _items[item]->mesh()->chunks_size(); ++chunk) {
+      _chunks.emplace_back(item, chunk);
+    }
+  }
+  jobs.parallel_for(_chunks.size(), [&](size_t index) {
+    project(_chunks[index].first, _chunks[index].second, camera, width, height);
+  });
+
+  // Set up triangles and bin them into the tiles they overlap.
+  _tiles_x = (width + TILE - 1) / TILE;
+  _tiles_y = (height + TILE - 1) / TILE;
+  size_t tiles = (size_t)_tiles_x * _tiles_y;
+
+  _slices = jobs.size() * SLICES_PER_THREAD;
+  _setup.resize(_stats.triangles);
+  _culled.assign(_slices, 0);
+  _bins.resize(_slices * tiles);
+  for (auto& bin : _bins) {
+    bin.clear();
+  }
+  jobs.parallel_for(_slices, [&](size_t slice) {
+    setup(slice, camera, width, height);
+  });
+
+  jobs.parallel_for(tiles, [&](size_t tile) {
+    raster(tile, framebuffer);
+  });
+
+  for (const auto& bin : _bins) {
+    _stats.binned += bin.size();
+  }
+  for (auto culled : _culled) {
+    _stats.culled += culled;
+  }
+}// render
+
+void
+SoftwareRenderer::collect(const Snapshot& snap)
+{
+  if (!snap.visible()) {
+    return;
+  }
+
+  const auto* meshed = dynamic_cast<const MeshSnapshot*>(&snap);
+  if (meshed != nullptr && meshed->mesh() != nullptr && meshed->mesh()->triangles_size() > 0) {
+    _items.push_back(meshed);
+  }
+
+  for (const auto& child : snap.children()) {
+    collect(*child);
+  }
+}// collect
+
+void
+SoftwareRenderer::project(size_t item, size_t chunk, const Camera& camera, int width, int height)
+{
+  const Mesh& mesh = *_items[item]->mesh();
+  const Transform& matrix = _items[item]->transform();
+
+  size_t first = chunk * Mesh::CHUNK;
+  size_t last = std::min(first + Mesh::CHUNK, mesh.vertices_size());
+  float* out = _screen.data() + 3 * (_vertices[item] + first);
+
+  for (size_t index = first; index < last; ++index, out += 3) {
+    const float* xyz = mesh.vertex(index);
+    float world[3];
+    for (int row = 0; row < 3; ++row) {
+      world[row] = matrix[row] * xyz[0] + matrix[4 + row] * xyz[1] + matrix[8 + row] * xyz[2] + matrix[12 + row];
+    }
+    camera.project(world, width, height, out);
+  }
+}// project
+
+void
+SoftwareRenderer::setup(size_t slice, const Camera& camera, int width, int height)
+{
+  size_t total = _stats.triangles;
+  size_t first = total * slice / _slices;
+  size_t last = total * (slice + 1) / _slices;
+  size_t tiles = (size_t)_tiles_x * _tiles_y;
+
+  size_t item = std::upper_bound(_triangles.begin(), _triangles.end(), first) - _triangles.begin() - 1;
+  size_t culled = 0;
+
+  for (size_t index = first; index < last; ++index) {
+    while (index >= _triangles[item + 1]) {
+      item++;
+    }
+
+    const auto& indices = _items[item]->mesh()->indices();
+    size_t local = index - _triangles[item];
+    const float* base = _screen.data() + 3 * _vertices[item];
+    const float* p0 = base + 3 * indices[3 * local];
+    const float* p1 = base + 3 * indices[3 * local + 1];
+    const float* p2 = base + 3 * indices[3 * local + 2];
+
+    float area = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p2[0] - p0[0]) * (p1[1] - p0[1]);
+    if (std::fabs(area) < std::numeric_limits<float>::epsilon()) {
+      culled++;
+      continue;
+    }
+    if (area < 0) {
+      std::swap(p1, p2);
+      area = -area;
+    }
+
+    if ((p0[2] > CLIPZ && p1[2] > CLIPZ && p2[2] > CLIPZ) ||
+        (p0[2] < -CLIPZ && p1[2] < -CLIPZ && p2[2] < -CLIPZ)) {
+      culled++;
+      continue;
+    }
+
+    // Pixels whose centers fall within the bounding box. It is clamped to
+    // the framebuffer as floats, since a vertex far off screen would
+    // overflow an int; the negated test also culls NaNs.
+    float left = std::ceil(std::min({ p0[0], p1[0], p2[0] }) - 0.5F);
+    float right = std::floor(std::max({ p0[0], p1[0], p2[0] }) - 0.5F);
+    float top = std::ceil(std::min({ p0[1], p1[1], p2[1] }) - 0.5F);
+    float bottom = std::floor(std::max({ p0[1], p1[1], p2[1] }) - 0.5F);
+    if (!(left <= right && top <= bottom && right >= 0 && bottom >= 0 &&
+          left <= (float)(width - 1) && top <= (float)(height - 1))) {
+      culled++;
+      continue;
+    }
+
+    int minx = (int)std::clamp(left, 0.0F, (float)(width - 1));
+    int maxx = (int)std::clamp(right, 0.0F, (float)(width - 1));
+    int miny = (int)std::clamp(top, 0.0F, (float)(height - 1));
+    int maxy = (int)std::clamp(bottom, 0.0F, (float)(height - 1));
+
+    Triangle& tri = _setup[index];
+    tri.minx = minx;
+    tri.maxx = maxx;
+    tri.miny = miny;
+    tri.maxy = maxy;
+
+    const float* corners[3] = { p0, p1, p2 };
+    for (int edge = 0; edge < 3; ++edge) {
+      const float* from = corners[edge];
+      const float* to = corners[(edge + 1) % 3];
+      tri.edge_a[edge] = from[1] - to[1];
+      tri.edge_b[edge] = to[0] - from[0];
+      tri.edge_c[edge] = -(tri.edge_a[edge] * from[0] + tri.edge_b[edge] * from[1]);
+    }
+
+    float dzdx = ((p1[2] - p0[2]) * (p2[1] - p0[1]) - (p2[2] - p0[2]) * (p1[1] - p0[1])) / area;
+    float dzdy = ((p2[2] - p0[2]) * (p1[0] - p0[0]) - (p1[2] - p0[2]) * (p2[0] - p0[0])) / area;
+    tri.depth_a = dzdx;
+    tri.depth_b = dzdy;
+    tri.depth_c = p0[2] - dzdx * p0[0] - dzdy * p0[1];
+
+    // Shade by the facing of the world-space normal.
+    float zoom = camera.zoom();
+    float ux = (p1[0] - p0[0]) / zoom;
+    float uy = (p1[1] - p0[1]) / zoom;
+    float uz = p1[2] - p0[2];
+    float vx = (p2[0] - p0[0]) / zoom;
+    float vy = (p2[1] - p0[1]) / zoom;
+    float vz = p2[2] - p0[2];
+    float nx = uy * vz - uz * vy;
+    float ny = uz * vx - ux * vz;
+    float nz = ux * vy - uy * vx;
+    float length = std::hypot(nx, ny, nz);
+    float facing = (length > 0) ? std::fabs(nz) / length : 1.0F;
+    auto shade = (uint8_t)(255.0F * GREY * (AMBIENT + (1.0F - AMBIENT) * facing));
+    tri.rgba = Framebuffer::rgba(shade, shade, shade);
+
+    for (int row = miny / TILE; row <= maxy / TILE; ++row) {
+      for (int col = minx / TILE; col <= maxx / TILE; ++col) {
+        _bins[slice * tiles + (size_t)row * _tiles_x + col].push_back((uint32_t)index);
+      }
+    }
+  }
+
+  _culled[slice] = culled;
+}// setup
+
+void
+SoftwareRenderer::raster(size_t tile, Framebuffer& framebuffer)
+{
+  int width = framebuffer.width();
+  int left = (int)(tile % _tiles_x) * TILE;
+  int top = (int)(tile / _tiles_x) * TILE;
+  int right = std::min(width, left + TILE) - 1;
+  int bottom = std::min(framebuffer.height(), top + TILE) - 1;
+  size_t tiles = (size_t)_tiles_x * _tiles_y;
+
+  uint32_t* color = framebuffer.color();
+  float* depth = framebuffer.depth();
+
+  for (size_t slice = 0; slice < _slices; ++slice) {
+    for (auto index : _bins[slice * tiles + tile]) {
+      const Triangle& tri = _setup[index];
+
+      int minx = std::max(left, tri.minx);
+      int maxx = std::min(right, tri.maxx);
+      int miny = std::max(top, tri.miny);
+      int maxy = std::min(bottom, tri.maxy);
+
+#if defined(__SSE2__)
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 lanes = _mm_set_ps(3.0F, 2.0F, 1.0F, 0.0F);
+      const __m128 near = _mm_set1_ps(-CLIPZ);
+      const __m128 far = _mm_set1_ps(CLIPZ);
+      const __m128 edge_a0 = _mm_set1_ps(tri.edge_a[0]);
+      const __m128 edge_a1 = _mm_set1_ps(tri.edge_a[1]);
+      const __m128 edge_a2 = _mm_set1_ps(tri.edge_a[2]);
+      const __m128 depth_a = _mm_set1_ps(tri.depth_a);
+      const __m128i rgba = _mm_set1_epi32((int)tri.rgba);
+#endif
+
+      for (int posy = miny; posy <= maxy; ++posy) {
+        float centery = (float)posy + 0.5F;
+        float row0 = tri.edge_b[0] * centery + tri.edge_c[0];
+        float row1 = tri.edge_b[1] * centery + tri.edge_c[1];
+        float row2 = tri.edge_b[2] * centery + tri.edge_c[2];
+        float rowz = tri.depth_b * centery + tri.depth_c;
+        size_t offset = (size_t)posy * width;
+        int posx = minx;
+
+#if defined(__SSE2__)
+        const __m128 edge_r0 = _mm_set1_ps(row0);
+        const __m128 edge_r1 = _mm_set1_ps(row1);
+        const __m128 edge_r2 = _mm_set1_ps(row2);
+        const __m128 depth_r = _mm_set1_ps(rowz);
+
+        for (; posx + 3 <= maxx; posx += 4) {
+          __m128 centerx = _mm_add_ps(_mm_set1_ps((float)posx + 0.5F), lanes);
+          __m128 inside = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a0, centerx), edge_r0), zero),
+                       _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a1, centerx), edge_r1), zero)),
+            _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a2, centerx), edge_r2), zero));
+          if (_mm_movemask_ps(inside) == 0) {
+            continue;
+          }
+
+          __m128 z = _mm_add_ps(_mm_mul_ps(depth_a, centerx), depth_r);
+          float* zbuffer = depth + offset + posx;
+          __m128 old = _mm_loadu_ps(zbuffer);
+          __m128 pass = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(z, old),
+                                                      _mm_and_ps(_mm_cmpge_ps(z, near), _mm_cmple_ps(z, far))));
+          if (_mm_movemask_ps(pass) == 0) {
+            continue;
+          }
+
+          _mm_storeu_ps(zbuffer, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, old)));
+          auto* pixels = reinterpret_cast<__m128i*>(color + offset + posx);
+          __m128i mask = _mm_castps_si128(pass);
+          __m128i under = _mm_loadu_si128(pixels);
+          _mm_storeu_si128(pixels, _mm_or_si128(_mm_and_si128(mask, rgba), _mm_andnot_si128(mask, under)));
+        }
+#endif
+
+        for (; posx <= maxx; ++posx) {
+          float centerx = (float)posx + 0.5F;
+          if (tri.edge_a[0] * centerx + row0 < 0 ||
+              tri.edge_a[1] * centerx + row1 < 0 ||
+              tri.edge_a[2] * centerx + row2 < 0) {
+            continue;
+          }
+          float z = tri.depth_a * centerx + rowz;
+          if (z < depth[offset + posx] && z >= -CLIPZ && z <= CLIPZ) {
+            depth[offset + posx] = z;
+            color[offset + posx] = tri.rgba;
+          }
+        }
+      }
+    }
+  }
+}// raster
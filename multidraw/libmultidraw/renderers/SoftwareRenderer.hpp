@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_SOFTWARE_RENDERER_HPP
+#define LIBMULTIDRAW_SOFTWARE_RENDERER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace multidraw {
+
+  class Camera;
+  class Framebuffer;
+  class JobSystem;
+  class MeshSnapshot;
+  class Snapshot;
+
+  /**
+   * @brief Draws a Snapshot into a Framebuffer on the CPU.
+   *
+   * Renders without a window or an OpenGL context, seeing the hierarchy
+   * through the same Camera as a Viewer. Vertices are projected and
+   * triangles binned into TILE x TILE screen tiles in parallel, then each
+   * tile is rasterized by one thread with SIMD edge functions and a depth
+   * test. Triangles are flat shaded with a light at the viewer.
+   */
+  class SoftwareRenderer {
+  public:
+    static const int TILE = 64;
+
+    struct Stats {
+      size_t triangles;
+      size_t culled;
+      size_t binned;
+    };
+
+    /// Renders on a JobSystem; by default, Multidraw's.
+    explicit SoftwareRenderer(JobSystem* = nullptr);
+
+    /// Clear and draw the visible meshes of a hierarchy.
+    void render(const Snapshot&, const Camera&, Framebuffer&);
+
+    /// Counters for the most recent render().
+    const Stats& stats() const { return _stats; };
+
+  private:
+    struct Triangle {
+      float edge_a[3];
+      float edge_b[3];
+      float edge_c[3];
+      float depth_a;
+      float depth_b;
+      float depth_c;
+      uint32_t rgba;
+      int minx;
+      int miny;
+      int maxx;
+      int maxy;
+    };
+
+    void collect(const Snapshot&);
+    void project(size_t item, size_t chunk, const Camera&, int width, int height);
+    void setup(size_t slice, const Camera&, int width, int height);
+    void raster(size_t tile, Framebuffer&);
+
+    JobSystem* _jobs;
+    std::vector<const MeshSnapshot*> _items;
+    std::vector<size_t> _vertices;
+    std::vector<size_t> _triangles;
+    std::vector<std::pair<size_t, size_t>> _chunks;
+    std::vector<float> _screen;
+    std::vector<Triangle> _setup;
+    std::vector<std::vector<uint32_t>> _bins;
+    std::vector<size_t> _culled;
+    size_t _slices;
+    int _tiles_x;
+    int _tiles_y;
+    Stats _stats;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_SOFTWARE_RENDERER_HPP
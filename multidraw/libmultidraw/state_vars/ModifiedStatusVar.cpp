@@ -26,10 +26,10 @@
 
 using namespace multidraw;
 
-ModifiedStatusVar::ModifiedStatusVar(Component* component, bool modified)
+ModifiedStatusVar::ModifiedStatusVar(Component* component, bool modified) :
+  _component(component),
+  _modified(modified)
 {
-  _component = component;
-  _modified = modified;
 }
 
 Component*
@@ -53,5 +53,8 @@ ModifiedStatusVar::modified() const
 void
 ModifiedStatusVar::modified(bool modified)
 {
-  _modified = modified;
+  if (_modified != modified) {
+    _modified = modified;
+    changed();
+  }
 }
@@ -35,5 +35,8 @@ NameVar::name() const
 void
 NameVar::name(const std::string& name)
 {
-  _name = name;
+  if (_name != name) {
+    _name = name;
+    changed();
+  }
 }// name
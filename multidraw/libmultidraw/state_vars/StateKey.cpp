@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/state_vars/StateKey.hpp> // class implemented
+
+#include <cctype>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace multidraw;
+
+// Constant-initialized, so usable from any other static initializer.
+const StateKey StateKey::COMPONENTNAME(0);
+const StateKey StateKey::MODIFIED(1);
+const StateKey StateKey::OUTPATH(2);
+
+struct StateKeyNames {
+  std::mutex mutex;
+  /// A deque, so references to names stay valid as it grows.
+  std::deque<std::string> names{"COMPONENTNAME", "MODIFIED", "OUTPATH"};
+  std::unordered_map<std::string, size_t> ids{{"COMPONENTNAME", 0}, {"MODIFIED", 1}, {"OUTPATH", 2}};
+};
+
+static StateKeyNames&
+names()
+{
+  static StateKeyNames table;
+  return table;
+}// names
+
+static std::string
+capitals(const std::string& name)
+{
+  std::string ALLCAPS = name;
+  for (auto& character: ALLCAPS) { character = (char)std::toupper((unsigned char)character); }
+  return ALLCAPS;
+}// capitals
+
+StateKey::StateKey(const std::string& name)
+{
+  std::string ALLCAPS = capitals(name);
+
+  StateKeyNames& table = names();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto [iter, added] = table.ids.try_emplace(ALLCAPS, table.names.size());
+  if (added) {
+    table.names.push_back(ALLCAPS);
+  }
+  _id = iter->second;
+}// constructor
+
+std::optional<StateKey>
+StateKey::find(const std::string& name)
+{
+  std::string ALLCAPS = capitals(name);
+
+  StateKeyNames& table = names();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto iter = table.ids.find(ALLCAPS);
+  if (iter == table.ids.end()) {
+    return std::nullopt;
+  }
+  return StateKey(iter->second);
+}// find
+
+const std::string&
+StateKey::name() const
+{
+  StateKeyNames& table = names();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.names[_id];
+}// name
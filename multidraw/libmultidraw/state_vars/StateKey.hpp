@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LIBMULTIDRAW_STATE_KEY_HPP
+#define LIBMULTIDRAW_STATE_KEY_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace multidraw {
+
+  /**
+   * The interned name of a State Variable.
+   *
+   * Names are case-insensitive. Making a key from a name looks it up
+   * once; after that, keys compare and index as small integers.
+   */
+  class StateKey {
+  public:
+    explicit StateKey(const std::string&);
+
+    /// The key of a name already seen, without adding the name if it is not.
+    static std::optional<StateKey> find(const std::string&);
+
+    /// Dense, from zero, in the order names were first seen.
+    size_t id() const { return _id; };
+    /// The name in capitals.
+    const std::string& name() const;
+
+    bool operator==(const StateKey&) const = default;
+
+    static const StateKey COMPONENTNAME;
+    static const StateKey MODIFIED;
+    static const StateKey OUTPATH;
+
+  private:
+    constexpr explicit StateKey(size_t id) : _id(id) {};
+
+    size_t _id;
+  };
+
+}
+
+#endif // LIBMULTIDRAW_STATE_KEY_HPP
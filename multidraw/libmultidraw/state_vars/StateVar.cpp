@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 1990, 1991 Stanford University
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of Stanford not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  Stanford makes no representations about
+ * the suitability of this software for any purpose.  It is provided "as is"
+ * without express or implied warranty.
+ *
+ * STANFORD DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL STANFORD BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <libmultidraw/state_vars/StateVar.hpp> // class implemented
+
+#include <algorithm>
+
+using namespace multidraw;
+
+/// Variables changed since the last flush.
+static std::vector<StateVar*> changes;
+/// The batch flush() is telling, if it is running.
+static std::vector<StateVar*>* telling = nullptr;
+
+StateVar::StateVar() :
+  _next(1),
+  _changed(false)
+{
+}// constructor
+
+StateVar::~StateVar()
+{
+  if (_changed) {
+    changes.erase(std::find(changes.begin(), changes.end(), this));
+  }
+  if (telling != nullptr) {
+    std::replace(telling->begin(), telling->end(), this, (StateVar*)nullptr);
+  }
+}// destructor
+
+StateVar::Id
+StateVar::subscribe(Observer observer)
+{
+  Id id = _next++;
+  _observers.emplace_back(id, std::move(observer));
+  return id;
+}// subscribe
+
+void
+StateVar::unsubscribe(Id id)
+{
+  auto iter = std::find_if(_observers.begin(), _observers.end(),
+                           [id](const auto& entry) { return entry.first == id; });
+  if (iter != _observers.end()) {
+    _observers.erase(iter);
+  }
+}// unsubscribe
+
+void
+StateVar::changed()
+{
+  // Nobody to tell, so nothing to remember.
+  if (!_changed && !_observers.empty()) {
+    _changed = true;
+    changes.push_back(this);
+  }
+}// changed
+
+size_t
+StateVar::flush()
+{
+  if (changes.empty() || telling != nullptr) {
+    return 0;
+  }
+
+  // Observers may change variables, or destroy them. Their changes wait
+  // for the next flush.
+  std::vector<StateVar*> batch;
+  batch.swap(changes);
+  for (auto* var : batch) {
+    var->_changed = false;
+  }
+  telling = &batch;
+
+  size_t told = 0;
+  std::vector<Id> ids;
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (batch[i] == nullptr) {
+      continue;
+    }
+
+    // By id, so an observer can unsubscribe any other while being told.
+    ids.clear();
+    for (const auto& entry : batch[i]->_observers) {
+      ids.push_back(entry.first);
+    }
+    for (Id id : ids) {
+      auto& observers = batch[i]->_observers;
+      auto iter = std::find_if(observers.begin(), observers.end(),
+                               [id](const auto& entry) { return entry.first == id; });
+      if (iter == observers.end()) {
+        continue;
+      }
+      // Copied, since it may unsubscribe itself.
+      Observer observer = iter->second;
+      try {
+        observer(*batch[i]);
+      } catch (...) {
+        telling = nullptr;
+        throw;
+      }
+      told++;
+      if (batch[i] == nullptr) {
+        break;
+      }
+    }
+  }
+
+  telling = nullptr;
+  return told;
+}// flush
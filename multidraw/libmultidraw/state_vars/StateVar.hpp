@@ -23,15 +23,49 @@
 #ifndef LIBMULTIDRAW_STATE_VAR_HPP
 #define LIBMULTIDRAW_STATE_VAR_HPP
 
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 namespace multidraw {
   
   /**
    * A State Variable is useful for storing a value.
+   *
+   * Observers subscribe to be told when it changes. Setters only mark
+   * the variable changed; flush() tells each observer once, however
+   * many times the value changed since the last flush. Multidraw::run
+   * flushes once per pass of its event loop, so the changes made while
+   * handling one event arrive together. State Variables belong to the
+   * main thread.
    */
   class StateVar {
   public:
-    StateVar() {};
-    virtual ~StateVar() {};
+    using Observer = std::function<void(StateVar&)>;
+    using Id = uint64_t;
+
+    StateVar();
+    virtual ~StateVar();
+
+    StateVar(const StateVar&) = delete;
+    StateVar& operator=(const StateVar&) = delete;
+
+    /// Call observer after each batch of changes. Returns an id for unsubscribe.
+    Id subscribe(Observer);
+    void unsubscribe(Id);
+    size_t observers() const { return _observers.size(); };
+
+    /// Tell the observers of every changed variable. Returns how many were told.
+    static size_t flush();
+
+  protected:
+    /// Sub-classes call this when their value changes.
+    void changed();
+
+  private:
+    std::vector<std::pair<Id, Observer>> _observers;
+    Id _next;
+    bool _changed;
   };
 
 }
@@ -0,0 +1,127 @@
+#include <filesystem>
+#include <iostream>
+#include <new>
+
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/History.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Every allocation in the process is counted. Only the plain forms are
+// replaced, with the sized delete alongside; the default array and
+// nothrow forms call these. The memory comes from, and goes back to,
+// the library's own aligned forms, which allocate and free as a pair.
+
+static size_t allocations = 0;
+
+void*
+operator new(size_t size)
+{
+  allocations++;
+  return ::operator new(size, std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__));
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  ::operator delete(ptr, std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__));
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  ::operator delete(ptr);
+}
+
+class AllocCatalog : public Catalog {
+public:
+  AllocCatalog() : Catalog("MultidrawAllocTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    return true;
+  }
+};
+
+class NudgeCmd : public Command {
+public:
+  NudgeCmd(Editor* editor, Component* comp, float delta) :
+    Command(editor, {comp}),
+    _delta(delta)
+  {
+  }
+
+  virtual bool merge(const Command& cmd)
+  {
+    _delta += static_cast<const NudgeCmd&>(cmd)._delta;
+    return true;
+  }
+
+private:
+  float _delta;
+};
+
+const int COMMANDS = 10000;
+const int WARMUP = 1000;
+
+/// Allocations made by executeCmd over COMMANDS commands, after WARMUP.
+static size_t
+measure(Editor* editor)
+{
+  Component* comp = editor->component();
+
+  for (int i = 0; i < WARMUP; i++) {
+    Multidraw::executeCmd(new NudgeCmd(editor, comp, 1.0F));
+  }
+
+  size_t total = 0;
+  for (int i = 0; i < COMMANDS; i++) {
+    // The caller owns allocating the command; the path from there must not.
+    Command* cmd = new NudgeCmd(editor, comp, 1.0F);
+    size_t before = allocations;
+    Multidraw::executeCmd(cmd);
+    total += allocations - before;
+  }
+
+  return total;
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new AllocCatalog());
+
+  Editor* editor = new Editor("./alloc", "");
+  multidraw->open(editor);
+  History* history = multidraw->history(editor->component());
+
+  int failures = 0;
+
+  // Commands within one gesture merge into a single History entry.
+  multidraw->beginGesture();
+  size_t merged = measure(editor);
+  multidraw->endGesture();
+  std::cout << "merged: " << merged << " allocations" << std::endl;
+  failures += merged == 0 ? 0 : 1;
+
+  // Commands kept apart, with the History held at its budget by eviction.
+  multidraw->mergeWindow(-1.0);
+  history->budget(100 * sizeof(NudgeCmd));
+  size_t logged = measure(editor);
+  std::cout << "logged: " << logged << " allocations, "
+            << history->past_size() << " in history, "
+            << history->stats().evicted << " evicted" << std::endl;
+  failures += logged == 0 ? 0 : 1;
+
+  multidraw->run();
+
+  delete multidraw;
+
+  return failures;
+}
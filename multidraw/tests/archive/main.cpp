@@ -0,0 +1,334 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Creator.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/commands/MacroCmd.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Writes Commands and Components to an Archive and reads them back:
+// round trips, skipping of unknown classes, rejection of records that
+// do not fit the document, and the time to store a million Commands.
+
+const int PARTS = 10;
+const int COMMANDS = 1000000;
+
+const double MAX_SECONDS = 1.0;
+
+const ClassId PATH_CMD = USER_CLASS;
+const ClassId PART_CMD = USER_CLASS + 1;
+const ClassId UNKNOWN_CMD = USER_CLASS + 2;
+
+/// Documents of PARTS parts, each with PARTS children, except "small".
+class ArchiveCatalog : public Catalog {
+public:
+  ArchiveCatalog() : Catalog("MultidrawArchiveTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    int parts = source.filename() == "small" ? 1 : PARTS;
+    comp = new Component("root");
+    for (int i = 0; i < parts; i++) {
+      auto* part = new Component(std::to_string(i));
+      for (int j = 0; j < parts; j++) {
+        part->add_child(new Component(std::to_string(j)));
+      }
+      comp->add_child(part);
+    }
+    return true;
+  }
+};
+
+/// Stores one path and a marker after it, reading them without Command::read.
+class PathCmd : public Command {
+public:
+  PathCmd(Editor* editor, Component* comp = nullptr, float marker = 0.0F) :
+    Command(editor),
+    _comp(comp),
+    _marker(marker)
+  {
+  }
+
+  virtual ClassId classid() const { return PATH_CMD; }
+
+  virtual bool write(Archive& archive) const
+  {
+    archive.write_path(_comp);
+    archive.write_float(_marker);
+    return true;
+  }
+
+  virtual bool read(Archive& archive)
+  {
+    _comp = archive.read_path();
+    _marker = archive.read_float();
+    return archive.good();
+  }
+
+  Component* comp() const { return _comp; }
+  float marker() const { return _marker; }
+
+private:
+  Component* _comp;
+  float _marker;
+};
+
+/// A Command on one Component, stored by Command alone.
+class PartCmd : public Command {
+public:
+  PartCmd(Editor* editor, Component* comp = nullptr) : Command(editor, {comp}) {}
+
+  virtual ClassId classid() const { return PART_CMD; }
+};
+
+/// A class the reading Creator does not define.
+class UnknownCmd : public Command {
+public:
+  UnknownCmd(Editor* editor) : Command(editor) {}
+
+  virtual ClassId classid() const { return UNKNOWN_CMD; }
+
+  virtual bool write(Archive& archive) const
+  {
+    archive.write_string("from a newer version");
+    return true;
+  }
+};
+
+static Command*
+make_path(Editor* editor)
+{
+  return new PathCmd(editor);
+}
+
+static Command*
+make_part(Editor* editor)
+{
+  return new PartCmd(editor);
+}
+
+static double
+since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+static int
+components(Creator& creator)
+{
+  Component root("root");
+  std::vector<float> vertices = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0 };
+  auto* part = new MeshComponent("part", std::make_shared<Mesh>(vertices, Mesh::Indices{ 0, 1, 2, 2, 1, 3 }));
+  Transform transform = part->transform();
+  transform[12] = 5.0F;
+  part->transform(transform);
+  part->visible(false);
+  root.add_child(part);
+  root.add_child(new Component("empty"));
+
+  std::stringstream stream;
+  Archive out(stream);
+  out.write(root);
+
+  Archive in(stream, creator);
+  std::unique_ptr<Component> copy(in.read_component());
+
+  int failures = 0;
+  failures += check(copy != nullptr && in.good(), "component read");
+  if (copy == nullptr) {
+    return failures;
+  }
+  auto* read = dynamic_cast<MeshComponent*>(copy->child("part"));
+  failures += check(copy->name() == "root" && copy->child("empty") != nullptr, "component names");
+  failures += check(read != nullptr && read->transform() == transform && !read->visible(), "mesh component fields");
+  if (read != nullptr) {
+    failures += check(read->mesh()->vertices_size() == 4 && read->mesh()->indices() == part->mesh()->indices(), "mesh");
+    failures += check(read->mesh()->vertex(3)[0] == 1.0F && read->mesh()->vertex(3)[1] == 1.0F, "vertices");
+  }
+  return failures;
+}
+
+static int
+corrupt(Creator& creator)
+{
+  // An index past the last vertex.
+  std::vector<float> vertices = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+  MeshComponent part("part", std::make_shared<Mesh>(vertices, Mesh::Indices{ 0, 1, 3 }));
+
+  std::stringstream stream;
+  Archive out(stream);
+  out.write(part);
+
+  Archive in(stream, creator);
+  Component* read = in.read_component();
+  int failures = check(read == nullptr && !in.good(), "index out of range rejected");
+  delete read;
+  return failures;
+}
+
+static int
+unknown(Creator& creator, Editor* editor)
+{
+  Component* part = editor->component()->child(3);
+
+  std::stringstream stream;
+  Archive out(stream);
+  out.write(PathCmd(editor, part, 1.0F));
+  out.write(UnknownCmd(editor));
+  out.write(PathCmd(editor, part, 2.0F));
+
+  Archive in(stream, creator, editor);
+  std::unique_ptr<Command> first(in.read_command());
+  std::unique_ptr<Command> second(in.read_command());
+  std::unique_ptr<Command> end(in.read_command());
+
+  auto* one = dynamic_cast<PathCmd*>(first.get());
+  auto* two = dynamic_cast<PathCmd*>(second.get());
+  int failures = 0;
+  failures += check(one != nullptr && one->comp() == part && one->marker() == 1.0F, "command before unknown");
+  failures += check(two != nullptr && two->comp() == part && two->marker() == 2.0F, "command after unknown");
+  failures += check(end == nullptr && in.skipped() == 1 && in.good(), "unknown skipped");
+  return failures;
+}
+
+static int
+macros(Creator& creator, Editor* editor)
+{
+  Component* root = editor->component();
+
+  // A parallel macro nested in a serial one, then a parallel one alone.
+  MacroCmd outer(editor);
+  auto inner = std::make_unique<MacroCmd>(editor);
+  inner->parallel(true);
+  inner->addChild(std::make_unique<PartCmd>(editor, root->child(1)));
+  inner->addChild(std::make_unique<PartCmd>(editor, root->child(2)));
+  outer.addChild(std::move(inner));
+  outer.addChild(std::make_unique<PartCmd>(editor, root->child(3)));
+  MacroCmd alone(editor);
+  alone.parallel(true);
+  alone.addChild(std::make_unique<PartCmd>(editor, root->child(4)));
+
+  std::stringstream stream;
+  Archive out(stream);
+  out.write(outer);
+  out.write(alone);
+  out.write(PathCmd(editor, root, 4.0F));
+
+  Archive in(stream, creator, editor);
+  std::unique_ptr<Command> first(in.read_command());
+  std::unique_ptr<Command> second(in.read_command());
+  std::unique_ptr<Command> third(in.read_command());
+
+  auto* serial = dynamic_cast<MacroCmd*>(first.get());
+  auto* parallel = dynamic_cast<MacroCmd*>(second.get());
+  auto* path = dynamic_cast<PathCmd*>(third.get());
+  int failures = 0;
+  failures += check(serial != nullptr && !serial->parallel() && serial->bytes() == outer.bytes(), "nested macro read");
+  failures += check(parallel != nullptr && parallel->parallel(), "parallel flag read");
+  failures += check(path != nullptr && path->marker() == 4.0F && in.good(), "command after macros");
+  return failures;
+}
+
+static int
+missing(Creator& creator, Editor* editor, Editor* small)
+{
+  // Two steps deep; the first already misses in the small document.
+  Component* deep = editor->component()->child(7)->child(2);
+
+  std::stringstream stream;
+  Archive out(stream);
+  out.write(PathCmd(editor, deep, 3.0F));
+  out.write(PartCmd(editor, deep));
+
+  Archive in(stream, creator, small);
+  std::unique_ptr<Command> first(in.read_command());
+  auto* path = dynamic_cast<PathCmd*>(first.get());
+
+  int failures = 0;
+  failures += check(path != nullptr && path->comp() == nullptr && path->marker() == 3.0F, "missed path read through");
+
+  std::unique_ptr<Command> second(in.read_command());
+  failures += check(second == nullptr && !in.good(), "command on a missing path rejected");
+  return failures;
+}
+
+static int
+million(Creator& creator, Editor* editor)
+{
+  Component* root = editor->component();
+
+  std::stringstream stream;
+  auto start = std::chrono::steady_clock::now();
+  Archive out(stream);
+  for (int i = 0; i < COMMANDS; i++) {
+    out.write(PartCmd(editor, root->child(i % PARTS)->child(i / PARTS % PARTS)));
+  }
+  double written = since(start);
+
+  start = std::chrono::steady_clock::now();
+  Archive in(stream, creator, editor);
+  int count = 0;
+  bool right = true;
+  for (Command* cmd = in.read_command(); cmd != nullptr; cmd = in.read_command()) {
+    right = right && cmd->clipboard()[0] == root->child(count % PARTS)->child(count / PARTS % PARTS);
+    count++;
+    delete cmd;
+  }
+  double read = since(start);
+
+  std::cout << COMMANDS << " commands: " << stream.str().size() << " bytes, written in "
+            << written << " s, read in " << read << " s" << std::endl;
+
+  int failures = 0;
+  failures += check(count == COMMANDS && right && in.good(), "million read back");
+  failures += check(written < MAX_SECONDS && read < MAX_SECONDS, "million within budget");
+  return failures;
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new ArchiveCatalog());
+
+  Creator creator;
+  creator.define(PATH_CMD, make_path);
+  creator.define(PART_CMD, make_part);
+
+  Editor* editor = new Editor("./archive", "");
+  multidraw->open(editor);
+  Editor* small = new Editor("./small", "");
+  multidraw->open(small);
+
+  int failures = 0;
+  failures += components(creator);
+  failures += corrupt(creator);
+  failures += unknown(creator, editor);
+  failures += macros(creator, editor);
+  failures += missing(creator, editor, small);
+  failures += million(creator, editor);
+
+  delete multidraw;
+
+  return failures;
+}
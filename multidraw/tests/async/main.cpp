@@ -0,0 +1,132 @@
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/History.hpp>
+#include <libmultidraw/JobSystem.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/commands/AsyncCmd.hpp>
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Submits AsyncCmds whose compute() succeeds, fails and throws, and
+// checks what their Handles report, that only the one that succeeded is
+// applied and logged, and that a throw on a worker thread fails the
+// command rather than the process.
+
+const size_t THREADS = 2;
+
+class AsyncCatalog : public Catalog {
+public:
+  AsyncCatalog() : Catalog("MultidrawAsyncTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    return true;
+  }
+};
+
+/// Computes nothing, and ends its computation as told.
+class OutcomeCmd : public AsyncCmd {
+public:
+  enum Outcome { SUCCEED, FAIL, THROW };
+
+  OutcomeCmd(Editor* editor, Component* comp, Outcome outcome) :
+    AsyncCmd(editor, {comp}),
+    _outcome(outcome)
+  {
+  }
+
+  static int applied;
+
+protected:
+  virtual bool compute(const Snapshot&)
+  {
+    if (_outcome == THROW) {
+      throw std::runtime_error("compute");
+    }
+    return _outcome == SUCCEED;
+  }
+
+  virtual void apply() { applied++; }
+
+private:
+  Outcome _outcome;
+};
+
+int OutcomeCmd::applied = 0;
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+static int
+submitted(Editor* editor)
+{
+  Multidraw* multidraw = Multidraw::instance();
+  Component* root = editor->component();
+  History* history = multidraw->history(root);
+
+  AsyncCmd::Handle thrown = multidraw->executeAsync(new OutcomeCmd(editor, root, OutcomeCmd::THROW));
+  AsyncCmd::Handle failed = multidraw->executeAsync(new OutcomeCmd(editor, root, OutcomeCmd::FAIL));
+  AsyncCmd::Handle done = multidraw->executeAsync(new OutcomeCmd(editor, root, OutcomeCmd::SUCCEED));
+  multidraw->run();
+
+  int failures = 0;
+  failures += check(thrown.status() == AsyncCmd::FAILED, "throwing compute failed");
+  failures += check(failed.status() == AsyncCmd::FAILED, "false compute failed");
+  failures += check(done.status() == AsyncCmd::DONE && done.progress() == 1.0F, "compute done");
+  failures += check(multidraw->asyncs() == 0, "every command back");
+  failures += check(OutcomeCmd::applied == 1 && history->past_size() == 1, "only the done command applied");
+  return failures;
+}
+
+static int
+worker(Editor* editor)
+{
+  // A JobSystem of its own, so that compute() runs on a worker whatever the machine.
+  JobSystem jobs(THREADS);
+  Component* root = editor->component();
+  std::shared_ptr<const Snapshot> state = root->snapshot();
+  OutcomeCmd cmd(editor, root, OutcomeCmd::THROW);
+  AsyncCmd::Handle handle = cmd.handle();
+
+  jobs.spawn([&cmd, state] {
+    cmd.run(*state);
+  });
+  while (!handle.finished()) {
+    std::this_thread::yield();
+  }
+
+  return check(handle.status() == AsyncCmd::FAILED, "throwing compute failed on a worker");
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new AsyncCatalog());
+
+  Editor* editor = new Editor("./async", "");
+  multidraw->open(editor);
+
+  int failures = 0;
+  failures += submitted(editor);
+  failures += worker(editor);
+
+  delete multidraw;
+
+  return failures;
+}
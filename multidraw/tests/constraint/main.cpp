@@ -0,0 +1,191 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libmultidraw/Constraint.hpp>
+#include <libmultidraw/ConstraintNetwork.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+using namespace multidraw;
+
+// Solves networks of Constraints that copy one Component's name to
+// another: order by rank, refusal of cycles, removal along with a
+// deleted Component, work in proportion to the change, and changes
+// reported from other threads.
+
+const int CHAIN = 100000;
+
+/// Gives its output the name of its input.
+class Follow : public Constraint {
+public:
+  Follow(Component* input, Component* output, std::vector<Constraint*>* order = nullptr) :
+    Constraint({input}, {output}),
+    _order(order)
+  {
+  }
+
+  virtual void solve()
+  {
+    if (_order != nullptr) {
+      _order->push_back(this);
+    }
+    // Only a change touches the output, and so dirties what reads it.
+    const std::string& name = inputs()[0]->name();
+    if (outputs()[0]->name() != name) {
+      outputs()[0]->name(name);
+    }
+  }
+
+private:
+  std::vector<Constraint*>* _order;
+};
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+static int
+order()
+{
+  ConstraintNetwork network;
+  Component a("a");
+  Component b("b");
+  Component c("c");
+
+  // Added downstream first, so adding order is not solving order.
+  std::vector<Constraint*> solved;
+  Constraint* second = network.add(std::make_unique<Follow>(&b, &c, &solved));
+  Constraint* first = network.add(std::make_unique<Follow>(&a, &b, &solved));
+  network.solve();
+
+  int failures = 0;
+  failures += check(first->rank() < second->rank(), "ranks follow dependencies");
+  failures += check(c.name() == "a", "chain solved through");
+
+  solved.clear();
+  a.name("z");
+  failures += check(network.solve() == 2 && solved.size() == 2 && solved[0] == first && solved[1] == second, "solved by rank");
+  failures += check(c.name() == "z" && !network.dirty(), "chain up to date");
+  return failures;
+}
+
+static int
+cycles()
+{
+  ConstraintNetwork network;
+  Component a("a");
+  Component b("b");
+  Component c("c");
+
+  network.add(std::make_unique<Follow>(&a, &b));
+  network.add(std::make_unique<Follow>(&b, &c));
+
+  int failures = 0;
+  failures += check(network.add(std::make_unique<Follow>(&c, &a)) == nullptr, "cycle refused");
+  failures += check(network.add(std::make_unique<Follow>(&a, &a)) == nullptr, "self cycle refused");
+  failures += check(network.stats().cycles == 2 && network.size() == 2, "cycles counted, nothing added");
+  return failures;
+}
+
+static int
+removal()
+{
+  ConstraintNetwork network;
+  Component a("a");
+  auto* b = new Component("b");
+  Component c("c");
+  Component d("d");
+
+  network.add(std::make_unique<Follow>(&a, b));
+  network.add(std::make_unique<Follow>(b, &c));
+  network.add(std::make_unique<Follow>(&a, &d));
+  network.solve();
+
+  delete b;
+
+  int failures = 0;
+  failures += check(network.size() == 1, "constraints on a deleted component removed");
+  a.name("y");
+  failures += check(network.solve() == 1 && d.name() == "y" && c.name() == "a", "the rest still solved");
+  return failures;
+}
+
+static int
+proportional()
+{
+  ConstraintNetwork network;
+  std::vector<std::unique_ptr<Component>> comps;
+  for (int i = 0; i <= CHAIN; i++) {
+    comps.push_back(std::make_unique<Component>("x"));
+  }
+  for (int i = 0; i < CHAIN; i++) {
+    network.add(std::make_unique<Follow>(comps[i].get(), comps[i + 1].get()));
+  }
+  network.solve();
+
+  int failures = 0;
+
+  // Near the end of the chain, only what is downstream is solved.
+  comps[CHAIN - 2]->name("y");
+  failures += check(network.solve() == 2 && comps[CHAIN]->name() == "y", "change near the end solves two");
+
+  // An unchanged output stops the pass.
+  comps[CHAIN - 2]->touch();
+  failures += check(network.solve() == 1, "unchanged output stops propagation");
+
+  comps[0]->name("z");
+  failures += check(network.solve() == (size_t)CHAIN && comps[CHAIN]->name() == "z", "change at the start solves all");
+
+  failures += check(network.solve() == 0 && network.stats().deferred == 0, "nothing left");
+  return failures;
+}
+
+static int
+threads()
+{
+  ConstraintNetwork network;
+  std::vector<std::unique_ptr<Component>> inputs;
+  std::vector<std::unique_ptr<Component>> outputs;
+  for (int i = 0; i < 8; i++) {
+    inputs.push_back(std::make_unique<Component>("x"));
+    outputs.push_back(std::make_unique<Component>("x"));
+    network.add(std::make_unique<Follow>(inputs.back().get(), outputs.back().get()));
+  }
+  network.solve();
+
+  // As the children of a parallel MacroCmd would.
+  std::vector<std::thread> workers;
+  for (int i = 0; i < 8; i++) {
+    workers.emplace_back([&inputs, i] { inputs[i]->name(std::to_string(i)); });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  int failures = 0;
+  failures += check(network.dirty(), "changes from other threads recorded");
+  failures += check(network.solve() == 8, "and solved by the owner");
+  bool followed = true;
+  for (int i = 0; i < 8; i++) {
+    followed = followed && outputs[i]->name() == std::to_string(i);
+  }
+  failures += check(followed, "every output follows");
+  return failures;
+}
+
+int main() {
+  int failures = 0;
+  failures += order();
+  failures += cycles();
+  failures += removal();
+  failures += proportional();
+  failures += threads();
+  return failures;
+}
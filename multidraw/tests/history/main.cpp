@@ -0,0 +1,413 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Creator.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/History.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/commands/MacroCmd.hpp>
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Runs commands on a document through Multidraw and checks what the
+// document holds after every undo and redo. Undoing and redoing many
+// steps at once, or more than there are, lands where stepping one at a
+// time would, including jumps that restore a checkpoint. A transaction
+// is one step, a rollback leaves neither changes nor History behind, and
+// an irreversible command waits for the outermost commit. Spillable MacroCmds logged
+// past the History's byte budget are written to its file, and undoing
+// and redoing through them brings the document back exactly.
+
+const int PARTS = 4;
+const int MACROS = 64;
+const int STEPS = 10;
+const int SLOW = 40;
+/// Seconds every slow command takes, and between checkpoints.
+const double COST = 0.001;
+const double INTERVAL = 5 * COST;
+const ClassId ADD_CMD = USER_CLASS;
+
+/// A version of a Tally.
+class TallySnapshot : public Snapshot {
+public:
+  TallySnapshot(const Component* comp, const std::string& name, bool visible, Children children, int value) :
+    Snapshot(comp, name, visible, std::move(children)),
+    value(value)
+  {
+  }
+
+  const int value;
+};
+
+/// A Component holding a number.
+class Tally : public Component {
+public:
+  explicit Tally(const std::string& name = "") : Component(name), value(0) {}
+
+  int value;
+
+protected:
+  virtual std::shared_ptr<const Snapshot> freeze(std::vector<std::shared_ptr<const Snapshot>> children) const
+  {
+    return std::make_shared<TallySnapshot>(this, name(), visible(), std::move(children), value);
+  }
+
+  virtual void thaw(const Snapshot& snap)
+  {
+    value = static_cast<const TallySnapshot&>(snap).value;
+  }
+};
+
+/// Documents of PARTS Tallies.
+class HistoryCatalog : public Catalog {
+public:
+  explicit HistoryCatalog(Creator* creator) : Catalog("MultidrawHistoryTest", creator) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    for (int i = 0; i < PARTS; i++) {
+      comp->add_child(new Tally(std::to_string(i)));
+    }
+    return true;
+  }
+};
+
+/// Adds an amount to the Tally in its clipboard.
+class AddCmd : public Command {
+public:
+  AddCmd(Editor* editor, Component* comp = nullptr, int amount = 0) :
+    Command(editor, {comp}),
+    _amount(amount)
+  {
+  }
+
+  virtual void execute() { add(_amount); }
+  virtual void unexecute() { add(-_amount); }
+
+  virtual ClassId classid() const { return ADD_CMD; }
+
+  virtual bool write(Archive& archive) const
+  {
+    if (!Command::write(archive)) {
+      return false;
+    }
+    archive.write_varint((uint64_t)_amount);
+    return true;
+  }
+
+  virtual bool read(Archive& archive)
+  {
+    if (!Command::read(archive)) {
+      return false;
+    }
+    _amount = (int)archive.read_varint();
+    return archive.good();
+  }
+
+private:
+  void add(int amount)
+  {
+    static_cast<Tally*>(clipboard()[0])->value += amount;
+    clipboard()[0]->touch();
+  }
+
+  int _amount;
+};
+
+/// An AddCmd that takes COST seconds each way.
+class SlowCmd : public AddCmd {
+public:
+  SlowCmd(Editor* editor, Component* comp, int amount) : AddCmd(editor, comp, amount) {}
+
+  virtual void execute() { spin(); AddCmd::execute(); }
+  virtual void unexecute() { spin(); AddCmd::unexecute(); }
+
+private:
+  static void spin()
+  {
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(COST);
+    while (std::chrono::steady_clock::now() < until) {
+    }
+  }
+};
+
+/// Counts its executions; with no clipboard, it cannot be undone.
+class CountCmd : public Command {
+public:
+  explicit CountCmd(Editor* editor) : Command(editor) {}
+
+  virtual void execute() { executed++; }
+
+  static int executed;
+};
+
+int CountCmd::executed = 0;
+
+static Command*
+make_add(Editor* editor)
+{
+  return new AddCmd(editor);
+}
+
+static int
+check(bool passed, const std::string& what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+/// Whether part i of the document holds values[i], for every part.
+static bool
+holds(Editor* editor, std::initializer_list<int> values)
+{
+  int i = 0;
+  for (int value : values) {
+    if (static_cast<Tally*>(editor->component()->child(i++))->value != value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void
+clear(Editor* editor)
+{
+  for (int i = 0; i < PARTS; i++) {
+    static_cast<Tally*>(editor->component()->child(i))->value = 0;
+  }
+  Multidraw::instance()->clearHistory(editor->component());
+}
+
+static int
+steps(Editor* editor)
+{
+  clear(editor);
+  Multidraw* multidraw = Multidraw::instance();
+  Component* root = editor->component();
+  History* history = multidraw->history(root);
+
+  // 1 + 2 + ... + STEPS, one command each.
+  for (int amount = 1; amount <= STEPS; amount++) {
+    Multidraw::executeCmd(new AddCmd(editor, root->child(0), amount));
+  }
+
+  int failures = 0;
+  failures += check(holds(editor, {55}) && history->past_size() == STEPS, "commands executed");
+
+  multidraw->undo(root, 3);
+  failures += check(holds(editor, {28}) && history->future_size() == 3, "three undone at once");
+
+  multidraw->redo(root, 2);
+  failures += check(holds(editor, {45}) && history->future_size() == 1, "two redone at once");
+
+  multidraw->undo(root, 0);
+  multidraw->redo(root, -1);
+  failures += check(holds(editor, {45}), "no steps, no change");
+
+  multidraw->undo(root, 100);
+  failures += check(holds(editor, {0}) && history->past_size() == 0, "undo past the start stops there");
+
+  multidraw->redo(root, 100);
+  failures += check(holds(editor, {55}) && history->future_size() == 0, "redo past the end stops there");
+
+  // A new command drops what could have been redone.
+  multidraw->undo(root, 5);
+  Multidraw::executeCmd(new AddCmd(editor, root->child(1), 7));
+  multidraw->redo(root, 1);
+  failures += check(holds(editor, {15, 7}) && history->future_size() == 0, "new command drops the future");
+  return failures;
+}
+
+static int
+checkpoints(Editor* editor)
+{
+  clear(editor);
+  Multidraw* multidraw = Multidraw::instance();
+  Component* root = editor->component();
+  History* history = multidraw->history(root);
+  history->interval(INTERVAL);
+  history->checkpointing(true);
+
+  for (int i = 0; i < SLOW; i++) {
+    Multidraw::executeCmd(new SlowCmd(editor, root->child(i % PARTS), 1));
+  }
+
+  const History::Stats& stats = history->stats();
+  int failures = 0;
+  failures += check(holds(editor, {10, 10, 10, 10}) && stats.checkpoints > 1, "checkpoints taken");
+
+  // To 17 commands, across several checkpoints.
+  multidraw->undo(root, SLOW - 17);
+  failures += check(holds(editor, {5, 4, 4, 4}), "jump back across checkpoints");
+  failures += check(stats.restored == 1 && stats.replayed < SLOW - 17, "jump back restored a checkpoint");
+
+  multidraw->redo(root, SLOW - 17);
+  failures += check(holds(editor, {10, 10, 10, 10}), "jump forward across checkpoints");
+  failures += check(stats.restored == 2, "jump forward restored a checkpoint");
+
+  // Stepping back one at a time lands in the same places.
+  multidraw->undo(root, 1);
+  failures += check(holds(editor, {10, 10, 10, 9}), "one step back");
+  multidraw->undo(root, SLOW);
+  failures += check(holds(editor, {0, 0, 0, 0}) && history->past_size() == 0, "jump back to the start");
+
+  // A command after an undo drops the checkpoints of the future it replaces.
+  multidraw->redo(root, 3);
+  Multidraw::executeCmd(new SlowCmd(editor, root->child(3), 5));
+  multidraw->undo(root, 4);
+  multidraw->redo(root, 4);
+  failures += check(holds(editor, {1, 1, 1, 5}), "new branch after a jump");
+
+  history->checkpointing(false);
+  return failures;
+}
+
+static int
+transactions(Editor* editor)
+{
+  clear(editor);
+  Multidraw* multidraw = Multidraw::instance();
+  Component* root = editor->component();
+  History* history = multidraw->history(root);
+  int failures = 0;
+
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new AddCmd(editor, root->child(0), 1));
+  Multidraw::executeCmd(new AddCmd(editor, root->child(1), 2));
+  failures += check(holds(editor, {1, 2}) && history->past_size() == 0, "executed before the commit");
+  multidraw->commit();
+  failures += check(holds(editor, {1, 2}) && history->past_size() == 1, "committed as one entry");
+
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new AddCmd(editor, root->child(0), 10));
+  Multidraw::executeCmd(new AddCmd(editor, root->child(2), 10));
+  multidraw->rollback();
+  failures += check(holds(editor, {1, 2, 0}) && history->past_size() == 1, "rolled back");
+
+  // The inner transaction is dropped, the outer one kept.
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new AddCmd(editor, root->child(2), 3));
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new AddCmd(editor, root->child(3), 4));
+  failures += check(holds(editor, {1, 2, 3, 4}), "nested executed");
+  multidraw->rollback();
+  failures += check(holds(editor, {1, 2, 3, 0}) && multidraw->transacting(), "nested rolled back");
+  multidraw->commit();
+  failures += check(holds(editor, {1, 2, 3, 0}) && history->past_size() == 2, "outer committed");
+
+  multidraw->undo(root, 1);
+  failures += check(holds(editor, {1, 2, 0, 0}), "outer undone as one");
+  multidraw->undo(root, 1);
+  failures += check(holds(editor, {0, 0, 0, 0}), "first undone as one");
+  multidraw->redo(root, 2);
+  failures += check(holds(editor, {1, 2, 3, 0}), "both redone");
+
+  // Irreversible commands run only once nothing could roll them back.
+  CountCmd::executed = 0;
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new CountCmd(editor));
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new CountCmd(editor));
+  multidraw->commit();
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new CountCmd(editor));
+  multidraw->rollback();
+  failures += check(CountCmd::executed == 0, "irreversible held");
+  multidraw->commit();
+  failures += check(CountCmd::executed == 2, "irreversible run at the outermost commit");
+  failures += check(history->past_size() == 2, "irreversible not in the History");
+
+  bool committed = multidraw->transaction(editor, [&]() {
+    Multidraw::executeCmd(new AddCmd(editor, root->child(0), 5));
+    return false;
+  });
+  failures += check(!committed && holds(editor, {1, 2, 3, 0}), "declined body rolled back");
+
+  bool thrown = false;
+  try {
+    multidraw->transaction(editor, [&]() -> bool {
+      Multidraw::executeCmd(new AddCmd(editor, root->child(0), 5));
+      throw std::runtime_error("failed");
+    });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  failures += check(thrown && holds(editor, {1, 2, 3, 0}) && !multidraw->transacting(), "throwing body rolled back");
+  return failures;
+}
+
+static int
+spilled(Editor* editor)
+{
+  clear(editor);
+  Multidraw* multidraw = Multidraw::instance();
+  Component* root = editor->component();
+  History* history = multidraw->history(root);
+
+  for (int macro = 0; macro < MACROS; macro++) {
+    auto* cmd = new MacroCmd(editor);
+    cmd->spillable(true);
+    for (int i = 0; i < PARTS; i++) {
+      cmd->addChild(std::make_unique<AddCmd>(editor, root->child(i), i + 1));
+    }
+    if (macro == 0) {
+      // Room for the hot commands and little more.
+      history->budget(2 * History::HOT * cmd->bytes());
+    }
+    Multidraw::executeCmd(cmd);
+  }
+
+  int failures = 0;
+  const History::Stats& stats = history->stats();
+  failures += check(stats.spilled > 0 && stats.evicted == 0, "macros over the budget spilled");
+  failures += check(stats.bytes < stats.peak, "spilling freed memory");
+  failures += check(holds(editor, {MACROS, 2 * MACROS, 3 * MACROS, 4 * MACROS}), "macros executed");
+
+  multidraw->undo(root, MACROS - 1);
+  failures += check(holds(editor, {1, 2, 3, 4}), "undone through spilled macros");
+
+  multidraw->undo(root, 1);
+  failures += check(holds(editor, {0, 0, 0, 0}), "undone to the start");
+  failures += check(stats.spilled == 0 && stats.evicted == 0, "spilled macros read back");
+
+  multidraw->redo(root, MACROS);
+  failures += check(holds(editor, {MACROS, 2 * MACROS, 3 * MACROS, 4 * MACROS}), "redone through read back macros");
+
+  history->budget(History::BUDGET);
+  return failures;
+}
+
+int main() {
+  Creator creator;
+  creator.define(ADD_CMD, make_add);
+
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new HistoryCatalog(&creator));
+
+  Editor* editor = new Editor("./history", "");
+  multidraw->open(editor);
+
+  int failures = 0;
+  failures += steps(editor);
+  failures += checkpoints(editor);
+  failures += transactions(editor);
+  failures += spilled(editor);
+
+  delete multidraw;
+
+  return failures;
+}
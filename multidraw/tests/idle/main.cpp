@@ -0,0 +1,92 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/IdleScheduler.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Runs idle tasks on a headless Multidraw while a transaction holds a
+// frame back, and checks that they get the whole idle budget, since
+// the held frame cannot be drawn before the commit anyway, and that the
+// frame runs once the transaction commits.
+
+const double BUDGET = 0.05;
+
+class IdleCatalog : public Catalog {
+public:
+  IdleCatalog() : Catalog("MultidrawIdleTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    return true;
+  }
+};
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+/// Seconds a task is given when the loop next goes idle.
+static double
+granted()
+{
+  double seconds = -1.0;
+  Multidraw::instance()->idle().post([&seconds](IdleScheduler::Clock::time_point deadline) {
+    seconds = std::chrono::duration<double>(deadline - IdleScheduler::Clock::now()).count();
+    return true;
+  });
+  Multidraw::instance()->run();
+  return seconds;
+}
+
+static int
+held(Editor* editor)
+{
+  Multidraw* multidraw = Multidraw::instance();
+  // Every frame is due at once, so only a transaction keeps one pending.
+  multidraw->frames().budget(0.0);
+  multidraw->idle().budget(BUDGET);
+
+  int failures = 0;
+  failures += check(granted() > BUDGET / 2, "whole budget with no frame pending");
+
+  multidraw->beginTransaction(editor);
+  multidraw->update();
+  double seconds = granted();
+  std::cout << "granted " << seconds << " s of " << BUDGET << " s while a frame is held" << std::endl;
+  failures += check(seconds > BUDGET / 2, "whole budget while a transaction holds a frame");
+  failures += check(multidraw->updated(), "frame held until the commit");
+
+  multidraw->commit();
+  multidraw->run();
+  failures += check(!multidraw->updated(), "frame run after the commit");
+  return failures;
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new IdleCatalog());
+
+  Editor* editor = new Editor("./idle", "");
+  multidraw->open(editor);
+
+  int failures = 0;
+  failures += held(editor);
+
+  delete multidraw;
+
+  return failures;
+}
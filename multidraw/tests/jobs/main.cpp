@@ -0,0 +1,207 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <libmultidraw/JobSystem.hpp>
+
+using namespace multidraw;
+
+// Stresses the JobSystem with one thread, a few and one per core:
+// nested parallel_for and fork/join, exceptions thrown across joins,
+// continuations with then(), and destruction with jobs still queued.
+
+const size_t OUTER = 64;
+const size_t INNER = 256;
+const int DEPTH = 12;
+const size_t FORKS = 1000;
+const size_t THROWING = 10;
+const size_t SPAWNS = 10000;
+const int ROUNDS = 20;
+
+static int
+check(bool passed, const std::string& what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+/// Count the nodes of a binary tree, forking and joining at every one.
+static void
+tree(JobSystem& jobs, int depth, std::atomic<size_t>& nodes)
+{
+  nodes++;
+  if (depth == 0) {
+    return;
+  }
+  JobSystem::Group group;
+  jobs.fork(group, [&jobs, depth, &nodes] { tree(jobs, depth - 1, nodes); });
+  jobs.fork(group, [&jobs, depth, &nodes] { tree(jobs, depth - 1, nodes); });
+  jobs.join(group);
+}
+
+/// Run what is posted until flag is set.
+static void
+wait_for(JobSystem& jobs, const std::atomic<bool>& flag)
+{
+  while (!flag) {
+    jobs.await();
+    jobs.complete();
+  }
+}
+
+static int
+nested(JobSystem& jobs, const std::string& name)
+{
+  std::atomic<size_t> calls(0);
+  std::atomic<size_t> sum(0);
+  jobs.parallel_for(OUTER, [&](size_t outer) {
+    jobs.parallel_for(INNER, [&](size_t inner) {
+      calls++;
+      sum += outer * INNER + inner;
+    });
+  });
+  size_t total = OUTER * INNER;
+
+  std::atomic<size_t> nodes(0);
+  tree(jobs, DEPTH, nodes);
+
+  int failures = 0;
+  failures += check(calls == total && sum == total * (total - 1) / 2, name + ": nested parallel_for");
+  failures += check(nodes == ((size_t)1 << (DEPTH + 1)) - 1, name + ": nested fork and join");
+  return failures;
+}
+
+static int
+exceptions(JobSystem& jobs, const std::string& name)
+{
+  int failures = 0;
+
+  // Every job runs, whichever throws; join rethrows one of them.
+  std::atomic<size_t> ran(0);
+  JobSystem::Group group;
+  for (size_t index = 0; index < FORKS; index++) {
+    jobs.fork(group, [&ran, index] {
+      ran++;
+      if (index % (FORKS / THROWING) == 0) {
+        throw std::runtime_error(std::to_string(index));
+      }
+    });
+  }
+  bool thrown = false;
+  try {
+    jobs.join(group);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  failures += check(thrown && ran == FORKS && group.done(), name + ": join rethrows after every job");
+
+  // Out of an inner parallel_for, through the outer one's join.
+  thrown = false;
+  try {
+    jobs.parallel_for(OUTER, [&](size_t outer) {
+      jobs.parallel_for(INNER, [&](size_t inner) {
+        if (outer == OUTER / 2 && inner == INNER / 2) {
+          throw std::runtime_error("inner");
+        }
+      });
+    });
+  } catch (const std::runtime_error& error) {
+    thrown = std::string(error.what()) == "inner";
+  }
+  failures += check(thrown, name + ": exception crosses nested joins");
+
+  // And nothing is left behind.
+  std::atomic<size_t> calls(0);
+  jobs.parallel_for(INNER, [&](size_t) { calls++; });
+  failures += check(calls == INNER, name + ": usable after exceptions");
+  return failures;
+}
+
+static int
+continuations(JobSystem& jobs, const std::string& name)
+{
+  int failures = 0;
+
+  // Runs once every job has finished, then hands a result back.
+  std::atomic<size_t> ran(0);
+  std::atomic<size_t> seen(0);
+  std::atomic<bool> posted(false);
+  JobSystem::Group group;
+  for (size_t index = 0; index < FORKS; index++) {
+    jobs.fork(group, [&ran] { ran++; });
+  }
+  jobs.then(group, [&] {
+    seen = ran.load();
+    jobs.post([&posted] { posted = true; });
+  });
+  jobs.join(group);
+  wait_for(jobs, posted);
+  failures += check(seen == FORKS, name + ": continuation after the group");
+
+  // On a group already done, and a chain of them.
+  std::atomic<int> links(0);
+  std::atomic<bool> chained(false);
+  jobs.then(group, [&] {
+    links++;
+    // Joined too, since with no workers only a join runs forked jobs.
+    JobSystem::Group next;
+    jobs.fork(next, [&links] { links++; });
+    jobs.then(next, [&] {
+      links++;
+      jobs.post([&chained] { chained = true; });
+    });
+    jobs.join(next);
+  });
+  wait_for(jobs, chained);
+  failures += check(links == 3, name + ": chained continuations");
+  return failures;
+}
+
+static int
+destruction(size_t threads, const std::string& name)
+{
+  auto token = std::make_shared<int>(0);
+  std::atomic<size_t> ran(0);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < ROUNDS; round++) {
+    auto jobs = std::make_unique<JobSystem>(threads);
+    JobSystem* system = jobs.get();
+    for (size_t index = 0; index < SPAWNS; index++) {
+      system->spawn([token, system, &ran] {
+        ran++;
+        std::this_thread::yield();
+        system->post([token] {});
+      });
+    }
+    jobs.reset();
+  }
+  std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start;
+
+  std::cout << name << ": " << ran << " of " << ROUNDS * SPAWNS << " detached jobs ran before destruction, "
+            << spent.count() << " s" << std::endl;
+
+  // Whatever was dropped, queued or posted, released what it held.
+  return check(token.use_count() == 1, name + ": queued and posted jobs freed");
+}
+
+int main() {
+  size_t cores = std::max(std::thread::hardware_concurrency(), 2U);
+
+  int failures = 0;
+  for (size_t threads : { (size_t)1, (size_t)4, cores }) {
+    std::string name = std::to_string(threads) + " threads";
+    JobSystem jobs(threads);
+    failures += nested(jobs, name);
+    failures += exceptions(jobs, name);
+    failures += continuations(jobs, name);
+    failures += destruction(threads, name);
+  }
+  return failures;
+}
@@ -0,0 +1,184 @@
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/commands/MacroCmd.hpp>
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Runs the same MacroCmds serially on one document and in parallel on
+// an identical one, over disjoint and overlapping clipboards, and checks
+// that both end on the same snapshot, after execution and after undo.
+
+const int PARTS = 16;
+const int ROUNDS = 50;
+
+/// Documents of PARTS parts, each with PARTS children.
+class MacroCatalog : public Catalog {
+public:
+  MacroCatalog() : Catalog("MultidrawMacroTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    for (int i = 0; i < PARTS; i++) {
+      auto* part = new Component(std::to_string(i));
+      for (int j = 0; j < PARTS; j++) {
+        part->add_child(new Component(std::to_string(j)));
+      }
+      comp->add_child(part);
+    }
+    return true;
+  }
+};
+
+/// Appends a suffix to the name of every Component in its clipboard's subtrees.
+class SuffixCmd : public Command {
+public:
+  SuffixCmd(Editor* editor, Component* comp, const std::string& suffix) :
+    Command(editor, {comp}),
+    _suffix(suffix)
+  {
+  }
+
+  virtual void execute()
+  {
+    for (Component* comp : clipboard()) {
+      append(comp);
+    }
+  }
+
+  virtual void unexecute()
+  {
+    for (Component* comp : clipboard()) {
+      strip(comp);
+    }
+  }
+
+private:
+  void append(Component* comp)
+  {
+    comp->name(comp->name() + _suffix);
+    for (size_t i = 0; i < comp->children_size(); i++) {
+      append(comp->child(i));
+    }
+  }
+
+  void strip(Component* comp)
+  {
+    comp->name(comp->name().substr(0, comp->name().size() - _suffix.size()));
+    for (size_t i = 0; i < comp->children_size(); i++) {
+      strip(comp->child(i));
+    }
+  }
+
+  std::string _suffix;
+};
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+static bool
+same(const Snapshot& left, const Snapshot& right)
+{
+  if (left.name() != right.name() || left.children_size() != right.children_size()) {
+    return false;
+  }
+  for (size_t i = 0; i < left.children_size(); i++) {
+    if (!same(*left.children()[i], *right.children()[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Each child on a part of its own.
+static MacroCmd*
+disjoint(Editor* editor, bool parallel, int round)
+{
+  Component* root = editor->component();
+  auto* macro = new MacroCmd(editor);
+  macro->parallel(parallel);
+  for (int i = 0; i < PARTS; i++) {
+    macro->addChild(std::make_unique<SuffixCmd>(editor, root->child(i), std::to_string(round)));
+  }
+  return macro;
+}
+
+/// Children on the same parts, and on parts and their children, whose order shows in the names.
+static MacroCmd*
+overlapping(Editor* editor, bool parallel, int round)
+{
+  Component* root = editor->component();
+  auto* macro = new MacroCmd(editor);
+  macro->parallel(parallel);
+  for (int i = 0; i < PARTS; i++) {
+    Component* part = root->child(i % 4);
+    macro->addChild(std::make_unique<SuffixCmd>(editor, part, "a" + std::to_string(i)));
+    macro->addChild(std::make_unique<SuffixCmd>(editor, part->child(i), "b" + std::to_string(i)));
+    macro->addChild(std::make_unique<SuffixCmd>(editor, root->child(PARTS - 1 - i % 4), "c" + std::to_string(round)));
+  }
+  macro->addChild(std::make_unique<SuffixCmd>(editor, root, "d"));
+  return macro;
+}
+
+static int
+compare(Editor* serial, Editor* parallel, MacroCmd* (*build)(Editor*, bool, int), const char* what)
+{
+  Component* serial_root = serial->component();
+  Component* parallel_root = parallel->component();
+  std::shared_ptr<const Snapshot> before = serial_root->snapshot();
+
+  bool executed = true;
+  for (int round = 0; round < ROUNDS; round++) {
+    Multidraw::executeCmd(build(serial, false, round));
+    Multidraw::executeCmd(build(parallel, true, round));
+    executed = executed && same(*serial_root->snapshot(), *parallel_root->snapshot());
+  }
+
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->undo(serial_root, ROUNDS);
+  multidraw->undo(parallel_root, ROUNDS);
+  bool undone = same(*parallel_root->snapshot(), *before) && same(*serial_root->snapshot(), *before);
+
+  std::string executed_what = std::string(what) + " executed alike";
+  std::string undone_what = std::string(what) + " undone alike";
+  int failures = 0;
+  failures += check(executed, executed_what.c_str());
+  failures += check(undone, undone_what.c_str());
+  return failures;
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new MacroCatalog());
+
+  Editor* serial = new Editor("./serial", "");
+  multidraw->open(serial);
+  Editor* parallel = new Editor("./parallel", "");
+  multidraw->open(parallel);
+
+  int failures = 0;
+  failures += compare(serial, parallel, disjoint, "disjoint");
+  failures += compare(serial, parallel, overlapping, "overlapping");
+
+  delete multidraw;
+
+  return failures;
+}
@@ -0,0 +1,343 @@
+#define GL_GLEXT_PROTOTYPES
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <FL/gl.h>
+#include <GL/glext.h>
+
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+#include <libmultidraw/renderers/BufferCache.hpp>
+#include <libmultidraw/renderers/RetainedRenderer.hpp>
+
+using namespace multidraw;
+
+// Draws with the RetainedRenderer into an offscreen framebuffer of a
+// surfaceless EGL context, in software: draw and instance counts with
+// and without instancing, coarse levels and their refinement within a
+// budget, and identical pixels wherever the result must not change.
+// Exits with SKIP when no such context can be made.
+
+const int SIZE = 128;
+const int SKIP = 77;
+
+const int COPIES = 300;
+/// Vertices along a side of a wavy grid, well over the coarsening threshold.
+const int GRID = 200;
+const int GRIDS = 3;
+/// A side of a grid whose vertices each fall in a cell of their own.
+const int SPREAD = 32;
+const int LAYERS = 3;
+
+/// A triangle-list Mesh from coordinates and indices.
+static std::shared_ptr<Mesh>
+mesh(const std::vector<float>& vertices, Mesh::Indices indices)
+{
+  return std::make_shared<Mesh>(vertices, std::move(indices));
+}
+
+static Transform
+translate(float deltax, float deltay, float deltaz = 0.0F)
+{
+  Transform transform = IDENTITY;
+  transform[12] = deltax;
+  transform[13] = deltay;
+  transform[14] = deltaz;
+  return transform;
+}
+
+static bool
+context()
+{
+  // The same rasterizer on every machine, so that pixels compare exactly.
+  setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+
+  auto platform = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  EGLDisplay display = platform != nullptr ? platform(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                                           : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  EGLint major = 0;
+  EGLint minor = 0;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API)) {
+    return false;
+  }
+
+  // Compatibility, for the fixed-function matrices the renderer uses.
+  const EGLint attributes[] = {
+    EGL_CONTEXT_MAJOR_VERSION, 3,
+    EGL_CONTEXT_MINOR_VERSION, 3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+    EGL_NONE
+  };
+  EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+  if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    return false;
+  }
+
+  GLuint framebuffer = 0;
+  GLuint renderbuffers[2] = {0, 0};
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glGenRenderbuffers(2, renderbuffers);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SIZE, SIZE);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SIZE, SIZE);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    return false;
+  }
+
+  glViewport(0, 0, SIZE, SIZE);
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(0, SIZE, 0, SIZE, -100, 100);
+  glEnable(GL_DEPTH_TEST);
+  return true;
+}
+
+static int
+check(bool passed, const std::string& what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+/// Clear, draw a frame and read it back.
+static std::vector<GLubyte>
+frame(RetainedRenderer& renderer, Component& root)
+{
+  glClearColor(0, 0, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  renderer.render(*root.snapshot());
+
+  std::vector<GLubyte> pixels(4 * SIZE * SIZE);
+  glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  return pixels;
+}
+
+static size_t
+lit(const std::vector<GLubyte>& pixels)
+{
+  size_t count = 0;
+  for (size_t index = 0; index < pixels.size(); index += 4) {
+    count += pixels[index] != 0 ? 1 : 0;
+  }
+  return count;
+}
+
+static int
+instancing()
+{
+  Component root("root");
+  root.visible(true);
+
+  // Copies of one triangle, every other one turned, and one quad.
+  auto triangle = mesh({ 0, 0, 0, 5, 0, 0, 0, 5, 0 }, { 0, 1, 2 });
+  std::vector<std::unique_ptr<MeshComponent>> parts;
+  for (int index = 0; index < COPIES; index++) {
+    Transform transform = translate((float)(index % 20) * 6.0F, (float)(index / 20) * 8.0F, (float)(index % 3));
+    if (index % 2 == 1) {
+      transform[0] = 0;
+      transform[1] = 1;
+      transform[4] = -1;
+      transform[5] = 0;
+      transform[12] += 5;
+    }
+    parts.push_back(std::make_unique<MeshComponent>(std::to_string(index), triangle));
+    parts.back()->transform(transform);
+    parts.back()->visible(true);
+    root.add_child(parts.back().get());
+  }
+  MeshComponent quad("quad", mesh({ 0, 0, 1, 3, 0, 1, 3, 3, 1, 0, 3, 1 }, { 0, 1, 2, 0, 2, 3 }));
+  quad.visible(true);
+  root.add_child(&quad);
+
+  // Neither is drawn.
+  parts[5]->visible(false);
+  MeshComponent empty("empty", mesh({}, {}));
+  empty.visible(true);
+  root.add_child(&empty);
+
+  RetainedRenderer renderer;
+  int failures = 0;
+
+  renderer.instancing(true);
+  std::vector<GLubyte> instanced = frame(renderer, root);
+  failures += check(renderer.stats().draws == 2 && renderer.stats().instances == COPIES, "one draw per mesh");
+  failures += check(renderer.stats().culled == 2, "hidden and empty not drawn");
+
+  renderer.instancing(false);
+  std::vector<GLubyte> separate = frame(renderer, root);
+  failures += check(renderer.stats().draws == COPIES && renderer.stats().instances == COPIES, "one draw per component");
+
+  failures += check(lit(instanced) > 1000 && instanced == separate, "instanced pixels identical");
+  failures += check(glGetError() == GL_NO_ERROR, "instancing without GL errors");
+  renderer.release();
+  return failures;
+}
+
+static int
+progressive()
+{
+  // Wavy grids, three of one Mesh each, and a triangle too small to coarsen.
+  std::vector<float> vertices;
+  Mesh::Indices indices;
+  for (int row = 0; row < GRID; row++) {
+    for (int col = 0; col < GRID; col++) {
+      float posx = (float)col * 40.0F / (GRID - 1);
+      float posy = (float)row * 40.0F / (GRID - 1);
+      vertices.insert(vertices.end(), { posx, posy, std::sin(posx * 0.3F) * 3.0F });
+    }
+  }
+  for (uint32_t row = 0; row + 1 < GRID; row++) {
+    for (uint32_t col = 0; col + 1 < GRID; col++) {
+      uint32_t corner = row * GRID + col;
+      indices.insert(indices.end(), { corner, corner + 1, corner + GRID + 1, corner, corner + GRID + 1, corner + GRID });
+    }
+  }
+
+  Component root("root");
+  root.visible(true);
+  std::vector<std::unique_ptr<MeshComponent>> grids;
+  for (int index = 0; index < GRIDS; index++) {
+    grids.push_back(std::make_unique<MeshComponent>(std::to_string(index), mesh(vertices, indices)));
+    grids.back()->transform(translate((float)index * 42.0F, 40.0F));
+    grids.back()->visible(true);
+    root.add_child(grids.back().get());
+  }
+  MeshComponent small("small", mesh({ 0, 0, 0, 20, 0, 0, 0, 20, 0 }, { 0, 1, 2 }));
+  small.visible(true);
+  root.add_child(&small);
+
+  // Room for one grid's coarse level a frame.
+  RetainedRenderer renderer;
+  renderer.progressive(true);
+  renderer.budget(100000);
+  int failures = 0;
+
+  bool paced = true;
+  std::vector<GLubyte> fine;
+  for (int index = 0; index < GRIDS; index++) {
+    fine = frame(renderer, root);
+    paced = paced && renderer.refining() == (index < GRIDS - 1) && renderer.stats().coarse == 0;
+  }
+  size_t triangles = renderer.stats().triangles;
+  failures += check(paced, "coarse levels built a mesh a frame while idle");
+
+  renderer.interactive(true);
+  std::vector<GLubyte> coarse = frame(renderer, root);
+  failures += check(renderer.stats().coarse == GRIDS && renderer.stats().triangles < triangles / 10, "coarse while interactive");
+  failures += check(renderer.stats().uploads == 0, "nothing uploaded while interactive");
+  size_t difference = lit(fine) > lit(coarse) ? lit(fine) - lit(coarse) : lit(coarse) - lit(fine);
+  failures += check(difference < lit(fine) / 20, "coarse covers nearly what fine does");
+
+  renderer.interactive(false);
+  paced = true;
+  std::vector<GLubyte> refined;
+  for (int index = 0; index < GRIDS; index++) {
+    refined = frame(renderer, root);
+    paced = paced && renderer.stats().coarse == (size_t)(GRIDS - 1 - index) && renderer.refining() == (index < GRIDS - 1);
+  }
+  failures += check(paced, "refined a mesh a frame");
+  failures += check(refined == fine && renderer.stats().triangles == triangles, "refined pixels identical");
+
+  renderer.interactive(true);
+  frame(renderer, root);
+  renderer.interactive(false);
+  renderer.budget(0);
+  frame(renderer, root);
+  failures += check(renderer.stats().coarse == 0 && !renderer.refining(), "no budget refines at once");
+
+  // A Mesh edited mid-gesture has no coarse level to draw.
+  renderer.interactive(true);
+  grids[0]->edit().vertex(0, 0, 0, 1);
+  frame(renderer, root);
+  failures += check(renderer.stats().coarse == GRIDS - 1, "edited mesh drawn in full");
+
+  failures += check(glGetError() == GL_NO_ERROR, "progressive without GL errors");
+  renderer.release();
+  return failures;
+}
+
+static int
+restore()
+{
+  // Layers of a grid with a vertex in every coarsening cell, so the
+  // coarse level keeps every triangle.
+  std::vector<float> vertices;
+  Mesh::Indices indices;
+  for (int layer = 0; layer < LAYERS; layer++) {
+    uint32_t base = (uint32_t)(vertices.size() / 3);
+    for (int row = 0; row < SPREAD; row++) {
+      for (int col = 0; col < SPREAD; col++) {
+        vertices.insert(vertices.end(), { (float)col, (float)row, (float)(layer * (SPREAD - 1) / (LAYERS - 1)) });
+      }
+    }
+    for (uint32_t row = 0; row + 1 < SPREAD; row++) {
+      for (uint32_t col = 0; col + 1 < SPREAD; col++) {
+        uint32_t corner = base + row * SPREAD + col;
+        indices.insert(indices.end(), { corner, corner + 1, corner + SPREAD + 1, corner, corner + SPREAD + 1, corner + SPREAD });
+      }
+    }
+  }
+
+  Component root("root");
+  root.visible(true);
+  MeshComponent part("part", mesh(vertices, indices));
+  part.visible(true);
+  root.add_child(&part);
+
+  RetainedRenderer renderer;
+  renderer.progressive(true);
+  frame(renderer, root);
+  renderer.interactive(true);
+  frame(renderer, root);
+
+  int failures = 0;
+  BufferCache::Buffers* buffers = renderer.cache()->find(*std::dynamic_pointer_cast<const MeshSnapshot>(part.snapshot()));
+  failures += check(buffers != nullptr && buffers->coarsened() && buffers->coarse_indices == buffers->indices, "coarse level as large as the mesh");
+  failures += check(renderer.stats().coarse == 1, "drawn coarse");
+
+  // The index buffer belongs to the vertex array, which the next full draw reuses.
+  bool restored = buffers != nullptr;
+  for (GLuint array = 1; restored && array < 64; array++) {
+    if (glIsVertexArray(array)) {
+      GLint bound = 0;
+      glBindVertexArray(array);
+      glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &bound);
+      restored = (GLuint)bound != buffers->coarse;
+    }
+  }
+  glBindVertexArray(0);
+  failures += check(restored, "full index buffer rebound after a coarse draw");
+
+  renderer.release();
+  return failures;
+}
+
+int main() {
+  if (!context()) {
+    std::cout << "No offscreen OpenGL context; skipped." << std::endl;
+    return SKIP;
+  }
+
+  int failures = 0;
+  failures += instancing();
+  failures += progressive();
+  failures += restore();
+  return failures;
+}
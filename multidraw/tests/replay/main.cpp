@@ -0,0 +1,196 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <FL/Enumerations.H>
+
+#include <libmultidraw/Archive.hpp>
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Creator.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/Recorder.hpp>
+#include <libmultidraw/Replay.hpp>
+#include <libmultidraw/commands/Command.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Usage: test_replay [session]
+//
+// Replays a session recorded against the document below and prints how
+// fast it ran. Without one, records a synthetic session first, with
+// transactions, rollbacks, undo and redo among the commands. Fails if
+// the session is malformed, or the replay ends on a different document
+// than the recording did.
+
+const int PARTS = 100;
+const int COMMANDS = 20000;
+/// The transaction, undo and redo recorded after the commands.
+const int EXTRA = 3;
+
+const ClassId MOVE_CMD = USER_CLASS;
+
+class ReplayCatalog : public Catalog {
+public:
+  ReplayCatalog() : Catalog("MultidrawReplayTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    for (int i = 0; i < PARTS; i++) {
+      std::vector<float> vertices = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+      comp->add_child(new MeshComponent(std::to_string(i), std::make_shared<Mesh>(vertices, Mesh::Indices{ 0, 1, 2 })));
+    }
+    return true;
+  }
+};
+
+class MoveCmd : public Command {
+public:
+  MoveCmd(Editor* editor, Component* comp = nullptr, float deltax = 0.0F, float deltay = 0.0F) :
+    Command(editor, {comp}),
+    _deltax(deltax),
+    _deltay(deltay)
+  {
+  }
+
+  virtual void execute() { move(_deltax, _deltay); }
+  virtual void unexecute() { move(-_deltax, -_deltay); }
+
+  virtual ClassId classid() const { return MOVE_CMD; }
+
+  virtual bool write(Archive& archive) const
+  {
+    if (!Command::write(archive)) {
+      return false;
+    }
+    archive.write_float(_deltax);
+    archive.write_float(_deltay);
+    return true;
+  }
+
+  virtual bool read(Archive& archive)
+  {
+    if (!Command::read(archive)) {
+      return false;
+    }
+    _deltax = archive.read_float();
+    _deltay = archive.read_float();
+    return archive.good();
+  }
+
+private:
+  void move(float deltax, float deltay)
+  {
+    auto* comp = static_cast<MeshComponent*>(clipboard()[0]);
+    Transform transform = comp->transform();
+    transform[12] += deltax;
+    transform[13] += deltay;
+    comp->transform(transform);
+  }
+
+  float _deltax;
+  float _deltay;
+};
+
+static Command*
+make_move(Editor* editor)
+{
+  return new MoveCmd(editor);
+}
+
+/// A drag of every part in turn, with the events that a Viewer would have seen.
+static void
+record(Editor* editor, std::ostream& out)
+{
+  Recorder recorder(out);
+  Multidraw::instance()->recorder(&recorder);
+
+  Component* root = editor->component();
+  for (int i = 0; i < COMMANDS; i++) {
+    if (i % PARTS == 0) {
+      recorder.record(editor, 0, Input{FL_MOUSEWHEEL, 0, 0, 1, 0});
+    }
+    Multidraw::executeCmd(new MoveCmd(editor, root->child(i % PARTS), 1.0F, -0.5F));
+  }
+
+  // Only what is committed is replayed.
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new MoveCmd(editor, root->child(0), 2.0F, 0.0F));
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new MoveCmd(editor, root->child(1), 4.0F, 0.0F));
+  multidraw->rollback();
+  multidraw->commit();
+  multidraw->beginTransaction(editor);
+  Multidraw::executeCmd(new MoveCmd(editor, root->child(2), 8.0F, 0.0F));
+  multidraw->rollback();
+
+  multidraw->undo(root, 3);
+  multidraw->redo(root, 1);
+  multidraw->run();
+
+  Multidraw::instance()->recorder(nullptr);
+  std::cout << "recorded " << recorder.commands() << " commands, "
+            << recorder.inputs() << " events" << std::endl;
+}
+
+static bool
+same(const Component* lhs, const Component* rhs)
+{
+  for (int i = 0; i < PARTS; i++) {
+    auto* left = static_cast<const MeshComponent*>(lhs->child(i));
+    auto* right = static_cast<const MeshComponent*>(rhs->child(i));
+    if (left->transform() != right->transform()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new ReplayCatalog());
+  multidraw->mergeWindow(-1.0);
+
+  Creator creator;
+  creator.define(MOVE_CMD, make_move);
+
+  std::stringstream session;
+  Editor* recorded = nullptr;
+  if (argc > 1) {
+    std::ifstream in(argv[1], std::ios::binary);
+    session << in.rdbuf();
+  } else {
+    recorded = new Editor("./replay", "");
+    multidraw->open(recorded);
+    record(recorded, session);
+  }
+
+  Editor* editor = new Editor("./replay", "");
+  multidraw->open(editor);
+
+  Replay replay(creator, editor);
+  bool good = replay.run(session);
+  replay.report(std::cout);
+
+  // Timings vary with the machine, so they are reported, never checked.
+  const Replay::Stats& stats = replay.stats();
+  int failures = 0;
+  failures += good ? 0 : 1;
+  if (recorded != nullptr) {
+    failures += stats.commands == (size_t)(COMMANDS + COMMANDS / PARTS + EXTRA) ? 0 : 1;
+    failures += same(recorded->component(), editor->component()) ? 0 : 1;
+  }
+
+  delete multidraw;
+
+  return failures;
+}
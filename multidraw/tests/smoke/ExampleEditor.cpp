@@ -11,11 +11,12 @@ ExampleEditor::ExampleEditor(const std::string& initial_file) :
 {
   Fl_Window* window = new Fl_Window(0, 0, WIDTH, HEIGHT, "MultidrawSmokeTest");
 
-  _viewer = new ExampleViewer(0, 0, WIDTH, HEIGHT, this);
+  Viewer* viewer = new ExampleViewer(0, 0, WIDTH, HEIGHT, this);
+  this->viewer(viewer, 0);
 
   window->end();
   
-  window->resizable(_viewer);
+  window->resizable(viewer);
   
   this->window(window);
 }// constructor
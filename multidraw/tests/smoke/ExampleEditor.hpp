@@ -8,11 +8,6 @@ using namespace multidraw;
 class ExampleEditor : public Editor {
 public:
   ExampleEditor(const std::string& initial_file);
-
-  virtual Viewer* viewer(int index) const { return _viewer; };
-  
-private:
-  Viewer* _viewer;
 };
 
 #endif // EXAMPLE_EDITOR_HPP
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+
+using namespace multidraw;
+
+// Takes Snapshots of a hierarchy before and after small changes, and
+// checks that unchanged subtrees and unchanged Mesh chunks are shared
+// with the earlier version, that the earlier version does not change,
+// and that a snapshot freezes only the changed nodes and their
+// ancestors, however large the tree. Restoring a version whose
+// Component has since been deleted leaves that Component out.
+
+const int SMALL = 10;
+const int LARGE = 100;
+
+/// A Component that counts the nodes frozen by every snapshot.
+class Counted : public Component {
+public:
+  explicit Counted(const std::string& name) : Component(name) {}
+
+  static size_t frozen;
+
+protected:
+  virtual std::shared_ptr<const Snapshot> freeze(std::vector<std::shared_ptr<const Snapshot>> children) const
+  {
+    frozen++;
+    return Component::freeze(std::move(children));
+  }
+};
+
+size_t Counted::frozen = 0;
+
+/// A root with parts children, each with parts children of its own.
+class Tree {
+public:
+  explicit Tree(int parts)
+  {
+    _nodes.push_back(std::make_unique<Counted>("root"));
+    for (int i = 0; i < parts; i++) {
+      _nodes.push_back(std::make_unique<Counted>(std::to_string(i)));
+      Component* part = _nodes.back().get();
+      root()->add_child(part);
+      for (int j = 0; j < parts; j++) {
+        _nodes.push_back(std::make_unique<Counted>(std::to_string(j)));
+        part->add_child(_nodes.back().get());
+      }
+    }
+  }
+
+  Component* root() const { return _nodes.front().get(); }
+
+private:
+  // Components do not own their children.
+  std::vector<std::unique_ptr<Counted>> _nodes;
+};
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+static int
+subtrees()
+{
+  Tree tree(SMALL);
+  Component* root = tree.root();
+  std::shared_ptr<const Snapshot> before = root->snapshot();
+
+  Counted::frozen = 0;
+  std::shared_ptr<const Snapshot> again = root->snapshot();
+  int failures = 0;
+  failures += check(again == before && Counted::frozen == 0, "untouched tree reused whole");
+
+  root->child(7)->child(3)->name("changed");
+  std::shared_ptr<const Snapshot> after = root->snapshot();
+  failures += check(after != before && Counted::frozen == 3, "only the leaf and its ancestors frozen");
+
+  bool shared = true;
+  for (size_t i = 0; i < after->children_size(); i++) {
+    bool changed = i == 7;
+    shared = shared && (after->children()[i] == before->children()[i]) != changed;
+  }
+  for (size_t j = 0; j < after->child(7)->children_size(); j++) {
+    bool changed = j == 3;
+    shared = shared && (after->child(7)->children()[j] == before->child(7)->children()[j]) != changed;
+  }
+  failures += check(shared, "unchanged subtrees shared");
+  failures += check(after->child(7)->child(3)->name() == "changed" && before->child(7)->child(3)->name() == "3",
+                    "earlier version unchanged");
+  return failures;
+}
+
+static int
+proportional()
+{
+  Tree small(SMALL);
+  Tree large(LARGE);
+  small.root()->snapshot();
+  large.root()->snapshot();
+
+  // One change in each: the same work, though one tree is a hundred times the other.
+  small.root()->child(1)->child(1)->name("changed");
+  Counted::frozen = 0;
+  small.root()->snapshot();
+  size_t in_small = Counted::frozen;
+
+  large.root()->child(1)->child(1)->name("changed");
+  Counted::frozen = 0;
+  large.root()->snapshot();
+  size_t in_large = Counted::frozen;
+
+  // And changes in several parts cost in proportion to their number.
+  for (int i = 0; i < SMALL; i++) {
+    large.root()->child(i)->child(i)->name("changed");
+  }
+  Counted::frozen = 0;
+  large.root()->snapshot();
+  size_t several = Counted::frozen;
+
+  int failures = 0;
+  failures += check(in_small == 3 && in_large == 3, "one change freezes its path, whatever the size");
+  failures += check(several == 2 * SMALL + 1, "changes freeze their paths once");
+  return failures;
+}
+
+static int
+chunks()
+{
+  // Three chunks of vertices.
+  std::vector<float> vertices(3 * 3 * Mesh::CHUNK, 0.0F);
+  Mesh::Indices indices = { 0, 1, 2 };
+  Component root("root");
+  MeshComponent part("part", std::make_shared<Mesh>(vertices, indices));
+  root.add_child(&part);
+
+  std::shared_ptr<const Snapshot> before = root.snapshot();
+  part.edit().vertex(Mesh::CHUNK + 1, 1.0F, 2.0F, 3.0F);
+  std::shared_ptr<const Snapshot> after = root.snapshot();
+
+  const auto* old_part = dynamic_cast<const MeshSnapshot*>(before->child(0));
+  const auto* new_part = dynamic_cast<const MeshSnapshot*>(after->child(0));
+  int failures = 0;
+  failures += check(old_part != nullptr && new_part != nullptr, "mesh snapshots");
+  if (old_part == nullptr || new_part == nullptr) {
+    return failures;
+  }
+
+  const Mesh& old_mesh = *old_part->mesh();
+  const Mesh& new_mesh = *new_part->mesh();
+  failures += check(&old_mesh != &new_mesh, "edited mesh copied");
+  failures += check(old_mesh.chunk(0) == new_mesh.chunk(0) && old_mesh.chunk(2) == new_mesh.chunk(2), "unchanged chunks shared");
+  failures += check(old_mesh.chunk(1) != new_mesh.chunk(1), "edited chunk copied");
+  failures += check(old_mesh.shared_indices() == new_mesh.shared_indices(), "indices shared");
+  failures += check(new_mesh.vertex(Mesh::CHUNK + 1)[1] == 2.0F && old_mesh.vertex(Mesh::CHUNK + 1)[1] == 0.0F,
+                    "earlier mesh unchanged");
+
+  // Unedited, the next snapshot shares the Mesh itself.
+  part.name("renamed");
+  std::shared_ptr<const Snapshot> renamed = root.snapshot();
+  const auto* same_part = dynamic_cast<const MeshSnapshot*>(renamed->child(0));
+  failures += check(same_part != nullptr && same_part->mesh() == new_part->mesh(), "unedited mesh shared");
+  return failures;
+}
+
+static int
+deleted()
+{
+  Component root("root");
+  Component kept("kept");
+  auto gone = std::make_unique<Component>("gone");
+  root.add_child(&kept);
+  root.add_child(gone.get());
+  std::shared_ptr<const Snapshot> before = root.snapshot();
+
+  gone.reset();
+  kept.name("renamed");
+  root.restore(before);
+
+  int failures = 0;
+  failures += check(before->child(1)->live() == nullptr, "deleted component expired");
+  failures += check(root.children_size() == 1 && root.child(0) == &kept, "deleted component left out");
+  failures += check(kept.name() == "kept", "live component restored");
+  return failures;
+}
+
+int main() {
+  int failures = 0;
+  failures += subtrees();
+  failures += proportional();
+  failures += chunks();
+  failures += deleted();
+  return failures;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <libmultidraw/Camera.hpp>
+#include <libmultidraw/JobSystem.hpp>
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/components/Mesh.hpp>
+#include <libmultidraw/components/MeshComponent.hpp>
+#include <libmultidraw/components/Snapshot.hpp>
+#include <libmultidraw/renderers/Framebuffer.hpp>
+#include <libmultidraw/renderers/SoftwareRenderer.hpp>
+
+using namespace multidraw;
+
+// Renders small scenes of known coverage with the SoftwareRenderer and
+// checks their pixels, across tile edges and with vertices so far off
+// the framebuffer that their pixel bounds do not fit in an int.
+
+const int WIDTH = 240;
+const int HEIGHT = 160;
+
+// As the renderer shades a face toward the viewer.
+const uint32_t BACKGROUND = Framebuffer::rgba(128, 128, 128);
+const uint32_t FACING = Framebuffer::rgba(204, 204, 204);
+
+// Far enough that (int) of a pixel bound overflows.
+const float FAR_OFF = 1e10F;
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+/// A facing quad from (left, bottom) to (right, top) in world units.
+static std::shared_ptr<Mesh>
+quad(float left, float bottom, float right, float top)
+{
+  return std::make_shared<Mesh>(std::vector<float>{ left, bottom, 0, right, bottom, 0, right, top, 0, left, top, 0 },
+                                Mesh::Indices{ 0, 1, 2, 0, 2, 3 });
+}
+
+static size_t
+covered(const Framebuffer& framebuffer)
+{
+  size_t count = 0;
+  for (int posy = 0; posy < framebuffer.height(); posy++) {
+    for (int posx = 0; posx < framebuffer.width(); posx++) {
+      count += framebuffer.pixel(posx, posy) == FACING ? 1 : 0;
+    }
+  }
+  return count;
+}
+
+/// Draw one mesh with the default Camera: 4 pixels to a unit, centered.
+static void
+render(std::shared_ptr<Mesh> mesh, SoftwareRenderer& renderer, Framebuffer& framebuffer)
+{
+  Component root("root");
+  MeshComponent part("mesh", std::move(mesh));
+  root.add_child(&part);
+  root.visible(true);
+  part.visible(true);
+  Camera camera;
+  renderer.render(*root.snapshot(), camera, framebuffer);
+}
+
+static int
+square(SoftwareRenderer& renderer)
+{
+  Framebuffer framebuffer(WIDTH, HEIGHT);
+
+  // To the pixels from (80, 60) to (159, 99), across four tiles.
+  render(quad(-10, -5, 10, 5), renderer, framebuffer);
+
+  int failures = 0;
+  failures += check(covered(framebuffer) == 80 * 40, "square covers its pixels");
+  failures += check(framebuffer.pixel(80, 60) == FACING && framebuffer.pixel(159, 99) == FACING, "square corners drawn");
+  failures += check(framebuffer.pixel(79, 60) == BACKGROUND && framebuffer.pixel(160, 99) == BACKGROUND &&
+                    framebuffer.pixel(80, 59) == BACKGROUND && framebuffer.pixel(159, 100) == BACKGROUND,
+                    "nothing drawn around the square");
+  failures += check(renderer.stats().triangles == 2 && renderer.stats().culled == 0, "square triangles counted");
+  return failures;
+}
+
+static int
+offscreen(SoftwareRenderer& renderer)
+{
+  Framebuffer framebuffer(WIDTH, HEIGHT);
+  int failures = 0;
+
+  // Covers the framebuffer with every vertex and edge far outside it.
+  auto huge = std::make_shared<Mesh>(std::vector<float>{ -FAR_OFF, -FAR_OFF, 0, 3 * FAR_OFF, -FAR_OFF, 0, -FAR_OFF, 3 * FAR_OFF, 0 },
+                                     Mesh::Indices{ 0, 1, 2 });
+  render(huge, renderer, framebuffer);
+  failures += check(covered(framebuffer) == (size_t)WIDTH * HEIGHT, "huge triangle covers the framebuffer");
+
+  // Wholly beyond each side, so culled rather than drawn along an edge.
+  render(quad(FAR_OFF, -5, 2 * FAR_OFF, 5), renderer, framebuffer);
+  failures += check(covered(framebuffer) == 0 && renderer.stats().culled == 2, "quad far right culled");
+  render(quad(-2 * FAR_OFF, -5, -FAR_OFF, 5), renderer, framebuffer);
+  failures += check(covered(framebuffer) == 0 && renderer.stats().culled == 2, "quad far left culled");
+  render(quad(-10, FAR_OFF, 10, 2 * FAR_OFF), renderer, framebuffer);
+  failures += check(covered(framebuffer) == 0 && renderer.stats().culled == 2, "quad far above culled");
+  render(quad(-10, -2 * FAR_OFF, 10, -FAR_OFF), renderer, framebuffer);
+  failures += check(covered(framebuffer) == 0 && renderer.stats().culled == 2, "quad far below culled");
+
+  // Just past the right edge: no pixel center inside.
+  render(quad(30, -5, 40, 5), renderer, framebuffer);
+  failures += check(covered(framebuffer) == 0, "quad just off screen not drawn");
+  return failures;
+}
+
+int main() {
+  JobSystem jobs(4);
+  SoftwareRenderer renderer(&jobs);
+
+  int failures = 0;
+  failures += square(renderer);
+  failures += offscreen(renderer);
+  return failures;
+}
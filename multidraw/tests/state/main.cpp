@@ -0,0 +1,119 @@
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/components/Component.hpp>
+#include <libmultidraw/state_vars/NameVar.hpp>
+#include <libmultidraw/state_vars/StateKey.hpp>
+#include <libmultidraw/state_vars/StateVar.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Looks up an Editor's State Variables by name, and checks that a name
+// with no variable finds nothing and is not registered by the lookup.
+// Changes a variable many times between flushes, and checks that each
+// observer is told once per batch, and only once it is flushed.
+
+const int CHANGES = 10;
+
+class StateCatalog : public Catalog {
+public:
+  StateCatalog() : Catalog("MultidrawStateTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    return true;
+  }
+};
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+static int
+lookup(Editor* editor)
+{
+  int failures = 0;
+  failures += check(editor->state("modified") == editor->state(StateKey::MODIFIED) &&
+                    editor->state(StateKey::MODIFIED) != nullptr, "known name, any case");
+
+  failures += check(!StateKey::find("NoSuchState"), "unknown name not yet seen");
+  failures += check(editor->state("NoSuchState") == nullptr, "unknown name finds nothing");
+  failures += check(!StateKey::find("nosuchstate"), "unknown name not registered by the lookup");
+
+  StateKey key("NoSuchState");
+  failures += check(StateKey::find("NOSUCHSTATE") == key, "made key found");
+  failures += check(editor->state(key) == nullptr, "made key has no variable");
+  return failures;
+}
+
+static int
+batches()
+{
+  NameVar first("first");
+  NameVar second("second");
+  NameVar quiet("quiet");
+  int told_first = 0;
+  int told_second = 0;
+  std::string seen;
+  first.subscribe([&](StateVar& var) {
+    told_first++;
+    seen = static_cast<NameVar&>(var).name();
+  });
+  StateVar::Id id = second.subscribe([&](StateVar&) { told_second++; });
+  second.subscribe([&](StateVar&) { told_second++; });
+
+  for (int i = 0; i < CHANGES; i++) {
+    first.name(std::to_string(i));
+    second.name(std::to_string(i));
+  }
+  // Unobserved, so never part of a batch.
+  quiet.name("changed");
+
+  int failures = 0;
+  failures += check(told_first == 0 && told_second == 0, "nobody told before the flush");
+  failures += check(StateVar::flush() == 3, "three observers told in one batch");
+  failures += check(told_first == 1 && seen == std::to_string(CHANGES - 1), "told once, of the last value");
+  failures += check(told_second == 2, "each observer told once");
+  failures += check(StateVar::flush() == 0 && told_first == 1, "nothing left to tell");
+
+  // Setting the same value again is no change.
+  first.name(std::to_string(CHANGES - 1));
+  second.unsubscribe(id);
+  second.name("again");
+  failures += check(StateVar::flush() == 1 && told_first == 1 && told_second == 3, "next batch");
+
+  // Multidraw flushes once a pass of its loop.
+  first.name("run");
+  first.name("run again");
+  Multidraw::instance()->run();
+  failures += check(told_first == 2 && seen == "run again", "flushed by the loop");
+  return failures;
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new StateCatalog());
+
+  Editor* editor = new Editor("./state", "");
+  multidraw->open(editor);
+
+  int failures = 0;
+  failures += lookup(editor);
+  failures += batches();
+
+  delete multidraw;
+
+  return failures;
+}
@@ -0,0 +1,156 @@
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <FL/Fl.H>
+
+#include <libmultidraw/Catalog.hpp>
+#include <libmultidraw/Editor.hpp>
+#include <libmultidraw/Input.hpp>
+#include <libmultidraw/Multidraw.hpp>
+#include <libmultidraw/Recorder.hpp>
+#include <libmultidraw/Viewer.hpp>
+#include <libmultidraw/components/Component.hpp>
+
+using namespace multidraw;
+namespace fs = std::filesystem;
+
+// Sends storms of FL_DRAG and FL_MOUSEWHEEL events to a Viewer on a
+// headless Multidraw, and checks that each storm reaches input() as one
+// event when the next frame runs: a drag at the latest position, a
+// wheel turned by the sum of its steps. Any other event delivers the
+// held one before itself. A Viewer without an Editor still takes input,
+// while a session is being recorded, and records none of it.
+
+const int SIZE = 100;
+const int STORM = 20;
+
+class ViewerCatalog : public Catalog {
+public:
+  ViewerCatalog() : Catalog("MultidrawViewerTest", nullptr) {}
+
+  virtual bool retrieve(const fs::path& source, Component*& comp)
+  {
+    comp = new Component("root");
+    return true;
+  }
+};
+
+/// A Viewer that remembers every event delivered to it.
+class Counting : public Viewer {
+public:
+  explicit Counting(Editor* editor) : Viewer(0, 0, SIZE, SIZE, editor) {}
+
+  virtual int input(const Input& in)
+  {
+    delivered.push_back(in);
+    return Viewer::input(in);
+  }
+
+  std::vector<Input> delivered;
+};
+
+static int
+check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::cout << "FAILED: " << what << std::endl;
+  }
+  return passed ? 0 : 1;
+}
+
+/// Hand the viewer an event as FLTK would.
+static void
+send(Viewer& viewer, int event, int posx, int posy, int dy)
+{
+  Fl::e_x = posx;
+  Fl::e_y = posy;
+  Fl::e_dy = dy;
+  viewer.handle(event);
+}
+
+static int
+storms(Editor* editor)
+{
+  Multidraw* multidraw = Multidraw::instance();
+  Counting viewer(editor);
+  int failures = 0;
+
+  send(viewer, FL_PUSH, 0, 0, 0);
+  for (int i = 1; i <= STORM; i++) {
+    send(viewer, FL_DRAG, i, 2 * i, 0);
+  }
+  failures += check(viewer.delivered.size() == 1, "drags held until the frame");
+  multidraw->run();
+  failures += check(viewer.delivered.size() == 2, "drag storm delivered once");
+  failures += check(viewer.delivered.back().event == FL_DRAG && viewer.delivered.back().x == STORM &&
+                    viewer.delivered.back().y == 2 * STORM, "latest drag position delivered");
+
+  // The release goes after the drags it ends, without waiting for a frame.
+  for (int i = 1; i <= STORM; i++) {
+    send(viewer, FL_DRAG, STORM + i, 0, 0);
+  }
+  send(viewer, FL_RELEASE, 2 * STORM, 0, 0);
+  failures += check(viewer.delivered.size() == 4 && viewer.delivered[2].event == FL_DRAG &&
+                    viewer.delivered[3].event == FL_RELEASE, "held drag delivered before the release");
+
+  for (int i = 0; i < STORM; i++) {
+    send(viewer, FL_MOUSEWHEEL, 0, 0, 1);
+  }
+  failures += check(viewer.delivered.size() == 4, "wheel held until the frame");
+  multidraw->run();
+  failures += check(viewer.delivered.size() == 5 && viewer.delivered.back().event == FL_MOUSEWHEEL &&
+                    viewer.delivered.back().dy == STORM, "wheel storm delivered once with its steps added");
+
+  // A different storm ends the one held.
+  send(viewer, FL_MOUSEWHEEL, 0, 0, -1);
+  send(viewer, FL_MOUSEWHEEL, 0, 0, -1);
+  send(viewer, FL_DRAG, 0, 0, 0);
+  failures += check(viewer.delivered.size() == 6 && viewer.delivered.back().dy == -2, "held wheel delivered before a drag");
+  multidraw->run();
+  failures += check(viewer.delivered.size() == 7 && viewer.delivered.back().event == FL_DRAG, "drag delivered at the frame");
+
+  failures += check(viewer.coalesced() == 3 * (STORM - 1) + 1, "merged events counted");
+  return failures;
+}
+
+static int
+detached()
+{
+  Multidraw* multidraw = Multidraw::instance();
+  std::ostringstream out;
+  Recorder recorder(out);
+  multidraw->recorder(&recorder);
+
+  Counting viewer(nullptr);
+  send(viewer, FL_KEYDOWN, 0, 0, 0);
+  send(viewer, FL_PUSH, 0, 0, 0);
+  send(viewer, FL_DRAG, 1, 1, 0);
+  send(viewer, FL_RELEASE, 1, 1, 0);
+  send(viewer, FL_MOUSEWHEEL, 0, 0, 1);
+  multidraw->run();
+  multidraw->recorder(nullptr);
+
+  int failures = 0;
+  failures += check(viewer.delivered.size() == 5, "input delivered without an editor");
+  failures += check(recorder.inputs() == 0, "input without an editor not recorded");
+  return failures;
+}
+
+int main() {
+  Multidraw* multidraw = Multidraw::instance();
+  multidraw->headless(true);
+  multidraw->catalog(new ViewerCatalog());
+
+  Editor* editor = new Editor("./viewer", "");
+  multidraw->open(editor);
+
+  int failures = 0;
+  failures += storms(editor);
+  failures += detached();
+
+  delete multidraw;
+
+  return failures;
+}